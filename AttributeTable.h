@@ -0,0 +1,27 @@
+#pragma once
+
+// Values of a per-player formula for every (agility, fearlessness) pair.
+// Attributes are 0..100, so a game formula that only depends on them is
+// computed once into a 101x101 table and the hot loops look it up. When the
+// formula is constexpr and the table is defined constexpr, it is built by
+// the compiler and lives in read-only data.
+template <class T>
+class AttributeTable
+{
+public:
+	static const unsigned int size = 101;
+
+	// formula(agility, fearlessness) for every pair
+	template <class Formula>
+	constexpr explicit AttributeTable(Formula formula) : values()
+	{
+		for (unsigned int agility = 0; agility < size; ++agility)
+			for (unsigned int fearlessness = 0; fearlessness < size; ++fearlessness)
+				values[agility][fearlessness] = formula(agility, fearlessness);
+	}
+
+	constexpr T operator()(unsigned int agility, unsigned int fearlessness) const { return values[agility][fearlessness]; }
+
+private:
+	T values[size][size];
+};
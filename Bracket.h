@@ -0,0 +1,316 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CompactPlayer.h"
+#include "Random.h"
+#include "Scheduler.h"
+
+// How a pairwise game pairs its players and how long it goes on
+struct BracketOptions
+{
+	enum Seeding
+	{
+		Adjacent,		// pairs (0,1), (2,3), ... in the current order
+		Shuffle,		// shuffled before the first round; later rounds pair winners in match order
+		PowerSorted		// strongest against weakest every round
+	};
+
+	Seeding seeding = Adjacent;
+	unsigned int maxRounds = 1;		// rounds to play at most
+	size_t target = 1;				// stop once this many players are left
+};
+
+// Player attributes the bracket needs, for compact records and Player objects
+inline int bracketNumber(const CompactPlayer& player) { return player.getNumber(); }
+inline int bracketPower(const CompactPlayer& player) { return player.getPower(); }
+template <class P> int bracketNumber(const P* player) { return player->getNumber(); }
+template <class P> int bracketPower(const P* player) { return player->getPower(); }
+
+// Single-elimination rounds over a flat array of players.
+// seedRound() puts a round's matches first, as pairs (2k, 2k+1), and its
+// byes after them. Byes go to the players with the fewest byes so far,
+// latest position first, so nobody sits out twice before everyone has
+// once. The last round plays only as many matches as it takes to reach
+// the target. Matches only read their own pair, so playMatches() runs
+// them in parallel; advance() then gathers the byes and the winners in
+// match order out of place.
+template <class Container>
+class Bracket
+{
+	typedef typename Container::value_type T;
+
+	BracketOptions options;
+	std::vector<uint8_t> byeCounts;		// by player number
+	std::vector<uint8_t> chosen;
+	std::vector<uint32_t> powerCounts;
+	std::vector<uint8_t> buckets;
+	Container scratch;
+	std::vector<uint64_t> results;
+	size_t matches = 0;
+	size_t byes = 0;
+	unsigned int round = 0;
+
+	void chooseByes(Container& players);
+	void seedMatches(Container& players, RandomBuffer& rng, TaskScheduler* scheduler);
+	void shuffle(Container& players, size_t count, RandomBuffer& rng, TaskScheduler* scheduler);
+public:
+	Bracket(const BracketOptions& options = BracketOptions()) : options(options) {};
+
+	// Sizes every buffer for up to playerCount players numbered up to maxNumber
+	void reserve(size_t playerCount, int maxNumber);
+
+	const BracketOptions& getOptions() const { return options; }
+	void setOptions(const BracketOptions& options) { this->options = options; }
+
+	// Starts a new game: no rounds played and no byes given
+	void reset();
+	bool hasNextRound(size_t playerCount) const;
+
+	// Starts the next round and arranges players for it; returns the number of matches.
+	// A scheduler lets a large shuffle run as tasks.
+	size_t seedRound(Container& players, RandomBuffer& rng, TaskScheduler* scheduler = nullptr);
+
+	// Decides every match with firstWins(player1, player2, rng).
+	// With a scheduler and more than grain matches, chunks of grain matches
+	// run as tasks, each with its own stream split off rng.
+	template <class Match>
+	void playMatches(const Container& players, Match firstWins, RandomBuffer& rng, TaskScheduler* scheduler, size_t grain);
+	bool firstWon(size_t match) const { return (results[match / 64] >> (match % 64)) & 1; }
+
+	// Keeps the byes, then the winners in match order
+	void advance(Container& players);
+
+	size_t getMatches() const { return matches; }
+	size_t getByes() const { return byes; }
+	unsigned int getRound() const { return round; }
+};
+
+
+template <class Container>
+void Bracket<Container>::reserve(size_t playerCount, int maxNumber)
+{
+	if (byeCounts.size() <= size_t(maxNumber))
+		byeCounts.resize(size_t(maxNumber) + 1, 0);
+
+	chosen.reserve(playerCount);
+	powerCounts.reserve(256);	// powers are at most 200
+	buckets.reserve(playerCount);
+	scratch.reserve(playerCount);
+	results.reserve((playerCount / 2 + 63) / 64);
+}
+
+template <class Container>
+void Bracket<Container>::reset()
+{
+	round = 0;
+	std::fill(byeCounts.begin(), byeCounts.end(), 0);
+}
+
+template <class Container>
+bool Bracket<Container>::hasNextRound(size_t playerCount) const
+{
+	return round < options.maxRounds && playerCount >= 2 && playerCount > options.target;
+}
+
+template <class Container>
+size_t Bracket<Container>::seedRound(Container& players, RandomBuffer& rng, TaskScheduler* scheduler)
+{
+	size_t count = players.size();
+	matches = count / 2;
+	if (count - matches < options.target)
+		matches = count > options.target ? count - options.target : 0;
+	byes = count - 2 * matches;
+
+	if (byes > 0)
+		chooseByes(players);
+	if (options.seeding != BracketOptions::Adjacent)
+		seedMatches(players, rng, scheduler);
+
+	round++;
+	return matches;
+}
+
+// Picks the byes and moves them behind the match players, keeping both groups in order
+template <class Container>
+void Bracket<Container>::chooseByes(Container& players)
+{
+	size_t count = players.size();
+	uint8_t level = 255;
+	for (auto& player : players)
+	{
+		size_t number = size_t(bracketNumber(player));
+		if (number >= byeCounts.size())
+			byeCounts.resize(number + 1, 0);
+		level = std::min(level, byeCounts[number]);
+	}
+
+	chosen.assign(count, 0);
+	size_t picked = 0;
+	for (; picked < byes; ++level)
+	{
+		for (size_t i = count; i-- > 0 && picked < byes;)
+		{
+			if (!chosen[i] && byeCounts[bracketNumber(players[i])] == level)
+			{
+				chosen[i] = 1;
+				picked++;
+			}
+		}
+		if (level == 255)
+			break;
+	}
+
+	scratch.resize(count);
+	size_t next = 0, nextBye = 2 * matches;
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (chosen[i])
+		{
+			uint8_t& byeCount = byeCounts[bracketNumber(players[i])];
+			if (byeCount < 255)
+				byeCount++;
+			scratch[nextBye++] = players[i];
+		}
+		else
+			scratch[next++] = players[i];
+	}
+	players.swap(scratch);
+}
+
+// Reorders the match players; the byes behind them stay where they are
+template <class Container>
+void Bracket<Container>::seedMatches(Container& players, RandomBuffer& rng, TaskScheduler* scheduler)
+{
+	size_t playing = 2 * matches;
+	if (playing < 2)
+		return;
+
+	// Only the first round needs shuffling: winners are gathered in match
+	// order, and after one uniform shuffle that order is itself uniformly
+	// random, so adjacent pairs stay random pairs in every later round
+	if (options.seeding == BracketOptions::Shuffle)
+	{
+		if (round == 0)
+			shuffle(players, playing, rng, scheduler);
+		return;
+	}
+
+	// Power-sorted: a stable counting sort by power, strongest first,
+	// then the k-th strongest meets the k-th weakest
+	int maxPower = 0;
+	for (size_t i = 0; i < playing; ++i)
+		maxPower = std::max(maxPower, bracketPower(players[i]));
+
+	powerCounts.assign(maxPower + 2, 0);
+	for (size_t i = 0; i < playing; ++i)
+		powerCounts[maxPower - bracketPower(players[i]) + 1]++;
+	for (size_t p = 1; p < powerCounts.size(); ++p)
+		powerCounts[p] += powerCounts[p - 1];
+
+	scratch.resize(players.size());
+	for (size_t i = 0; i < playing; ++i)
+	{
+		size_t rank = powerCounts[maxPower - bracketPower(players[i])]++;
+		size_t slot = rank < matches ? 2 * rank : 2 * (playing - 1 - rank) + 1;
+		scratch[slot] = players[i];
+	}
+	std::copy(players.begin() + playing, players.end(), scratch.begin() + playing);
+	players.swap(scratch);
+}
+
+// Uniform shuffle of the first count players.
+// Small arrays use Fisher-Yates. Large ones scatter every player into one
+// of 256 random buckets and shuffle each bucket on its own (Rao-Sandelius),
+// which is still exactly uniform but keeps the random swaps within a
+// cache-sized bucket and lets the buckets run in parallel.
+template <class Container>
+void Bracket<Container>::shuffle(Container& players, size_t count, RandomBuffer& rng, TaskScheduler* scheduler)
+{
+	const size_t smallShuffle = 1 << 16;
+	if (count <= smallShuffle)
+	{
+		for (size_t i = count - 1; i > 0; --i)
+			std::swap(players[i], players[rng.nextBelow(unsigned(i + 1))]);
+		return;
+	}
+
+	buckets.resize(count);
+	size_t offsets[257] = {};
+	for (size_t i = 0; i < count; i += 4)
+	{
+		uint32_t word = rng.nextWord();
+		for (size_t j = i; j < i + 4 && j < count; ++j, word >>= 8)
+		{
+			buckets[j] = uint8_t(word);
+			offsets[buckets[j] + 1]++;
+		}
+	}
+	for (size_t b = 1; b <= 256; ++b)
+		offsets[b] += offsets[b - 1];
+
+	scratch.resize(players.size());
+	size_t next[256];
+	std::copy(offsets, offsets + 256, next);
+	for (size_t i = 0; i < count; ++i)
+		scratch[next[buckets[i]]++] = players[i];
+	std::copy(players.begin() + count, players.end(), scratch.begin() + count);
+	players.swap(scratch);
+
+	uint64_t streams = (uint64_t(rng.nextWord()) << 32) | rng.nextWord();
+	auto shuffleBuckets = [&](size_t first, size_t last) {
+		for (size_t b = first; b < last; ++b)
+		{
+			RandomBuffer bucketRng(streams + b);
+			for (size_t i = offsets[b + 1] - offsets[b]; i > 1; --i)
+				std::swap(players[offsets[b] + i - 1], players[offsets[b] + bucketRng.nextBelow(unsigned(i))]);
+		}
+	};
+
+	if (scheduler)
+		scheduler->parallelFor(0, 256, 16, shuffleBuckets);
+	else
+		shuffleBuckets(0, 256);
+}
+
+template <class Container>
+template <class Match>
+void Bracket<Container>::playMatches(const Container& players, Match firstWins, RandomBuffer& rng, TaskScheduler* scheduler, size_t grain)
+{
+	results.assign((matches + 63) / 64, 0);
+
+	auto play = [&](size_t first, size_t last, RandomBuffer& random) {
+		for (size_t k = first; k < last; ++k)
+		{
+			if (firstWins(players[2 * k], players[2 * k + 1], random))
+				results[k / 64] |= uint64_t(1) << (k % 64);
+		}
+	};
+
+	if (!scheduler || matches <= grain)
+	{
+		play(0, matches, rng);
+		return;
+	}
+
+	// Whole result words per chunk, so no two tasks write the same word
+	grain = (grain + 63) & ~size_t(63);
+	uint64_t streams = (uint64_t(rng.nextWord()) << 32) | rng.nextWord();
+	scheduler->parallelFor(0, matches, grain, [&](size_t first, size_t last) {
+		RandomBuffer chunkRng(streams + first / grain);
+		play(first, last, chunkRng);
+	});
+}
+
+template <class Container>
+void Bracket<Container>::advance(Container& players)
+{
+	scratch.resize(byes + matches);
+	for (size_t b = 0; b < byes; ++b)
+		scratch[b] = players[2 * matches + b];
+	for (size_t k = 0; k < matches; ++k)
+		scratch[byes + k] = firstWon(k) ? players[2 * k] : players[2 * k + 1];
+
+	players.swap(scratch);
+}
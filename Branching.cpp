@@ -0,0 +1,62 @@
+#include "Branching.h"
+#include "Game.h"
+#include "Random.h"
+#include "Scheduler.h"
+
+// The first game leaves its survivors in the branch's own population
+void BranchPopulation::play(Game& game, RandomBuffer& rng)
+{
+	if (owned)
+	{
+		game.playCompact(own, rng);
+		return;
+	}
+
+	game.playCompactFrom(*shared, own, rng);
+	shared.reset();
+	owned = true;
+}
+
+void TournamentFork::addBranch(uint64_t seed, const std::vector<const Game*>& games)
+{
+	Continuation continuation;
+	continuation.seed = seed;
+	continuation.games = games;
+	continuations.push_back(continuation);
+}
+
+// Plays one continuation on a copy-on-write view of the snapshot.
+// A branch without games never copies the shared players, and its first
+// game copies only the players it keeps.
+void TournamentFork::runBranch(size_t index)
+{
+	const Continuation& continuation = continuations[index];
+	std::vector<GameRecord>& branchResults = results[index];
+
+	RandomBuffer rng(continuation.seed);
+	BranchPopulation population(snapshot);
+
+	branchResults.resize(continuation.games.size());
+	for (size_t i = 0; i < continuation.games.size(); ++i)
+	{
+		std::unique_ptr<Game> game(continuation.games[i]->clone());
+		game->setScheduler(scheduler);
+		population.play(*game, rng);
+
+		branchResults[i] = makeRecord(*game);
+	}
+}
+
+// Runs every branch as its own task; big branches may split further on the same pool
+void TournamentFork::run(TaskScheduler* scheduler)
+{
+	TaskScheduler& pool = scheduler ? *scheduler : TaskScheduler::shared();
+	this->scheduler = &pool;
+
+	results.assign(continuations.size(), std::vector<GameRecord>());
+
+	pool.parallelFor(0, continuations.size(), 1, [this](size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i)
+			runBranch(i);
+	});
+}
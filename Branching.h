@@ -0,0 +1,71 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "CompactPlayer.h"
+#include "Tournament.h"
+
+class Game;
+class TaskScheduler;
+
+// Read-only survivors of a tournament prefix (games 0..k-1).
+// Copies share the same player data.
+class PopulationSnapshot
+{
+	std::shared_ptr<const Population> data;
+	size_t games_played = 0;
+public:
+	PopulationSnapshot() : data(std::make_shared<const Population>()) {};
+	PopulationSnapshot(Population population, size_t gamesPlayed)
+		: data(std::make_shared<const Population>(std::move(population))), games_played(gamesPlayed) {};
+
+	const Population& getPlayers() const { return *data; }
+	size_t getGamesPlayed() const { return games_played; }
+	std::shared_ptr<const Population> share() const { return data; }
+};
+
+// Copy-on-write view of a snapshot owned by one branch.
+// Until the branch's first game its players are the shared data. That
+// game reads them in place with Game::playCompactFrom() and writes only
+// its survivors to the branch's own population, so the players it loses
+// are never copied; later games play on the branch's own players.
+class BranchPopulation
+{
+	std::shared_ptr<const Population> shared;
+	Population own;
+	bool owned = false;
+public:
+	BranchPopulation(const PopulationSnapshot& snapshot) : shared(snapshot.share()) {};
+
+	const Population& read() const { return owned ? own : *shared; }
+	void play(Game& game, RandomBuffer& rng);
+	bool isShared() const { return !owned; }
+};
+
+// One continuation: a seed and the games to play after the snapshot.
+// The games are prototypes; each run plays on its own clone().
+struct Continuation
+{
+	uint64_t seed = 0;
+	std::vector<const Game*> games;
+};
+
+// Forks many continuations from one shared prefix state and runs them in parallel
+class TournamentFork
+{
+	PopulationSnapshot snapshot;
+	std::vector<Continuation> continuations;
+	std::vector<std::vector<GameRecord>> results;
+	TaskScheduler* scheduler = nullptr;
+
+	void runBranch(size_t index);
+public:
+	TournamentFork(const PopulationSnapshot& snapshot) : snapshot(snapshot) {};
+
+	void addBranch(uint64_t seed, const std::vector<const Game*>& games);
+	// Runs every branch as a task (nullptr = TaskScheduler::shared())
+	void run(TaskScheduler* scheduler = nullptr);
+
+	size_t getBranchCount() const { return continuations.size(); }
+	const std::vector<GameRecord>& getResults(size_t branch) const { return results[branch]; }
+};
@@ -0,0 +1,610 @@
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <mutex>
+#include "Game.h"
+#include "Player.h"
+#include "Random.h"
+#include "ImportanceSampling.h"
+#include "Scheduler.h"
+
+// Compact versions of the games.
+// Each playCompact() follows the same rules as play() on a flat array of
+// CompactPlayer records, without messages, and shrinks the array in place
+// so survivors keep the order play() would leave them in.
+// When a sampler is attached, the draws deciding the target's fate go through it.
+
+
+// Fallback for games without a compact version:
+// round-trips the population through Player objects and play().
+// play() draws from the shared Player buffer, so it is reseeded from rng
+// first and the run follows the caller's seed like every compact game.
+// That buffer and TextOut::standard() are shared by every game, so
+// fallback games run one at a time even when runners call them in parallel.
+void Game::playCompact(Population& population, RandomBuffer& rng)
+{
+	static std::mutex fallbackLock;
+	std::lock_guard<std::mutex> hold(fallbackLock);
+
+	Player::getRandomBuffer().reseed((uint64_t(rng.nextWord()) << 32) | rng.nextWord());
+
+	for (auto& p : population)
+	{
+		Player player(p.getNumber(), p.getAgility(), p.getFearlessness());
+		join(&player);
+	}
+
+	play();
+	TextOut::standard().flush();
+
+	population.clear();
+	for (auto player : players)
+		population.push_back(CompactPlayer(player->getNumber(), player->getAgility(), player->getFearlessness()));
+
+	compact_winner = winner ? CompactPlayer(winner->getNumber(), winner->getAgility(), winner->getFearlessness()) : CompactPlayer();
+	winner = nullptr;
+
+	for (auto player : players)
+		delete player;
+	players.clear();
+}
+
+void Game::playCompactFrom(const Population& source, Population& population, RandomBuffer& rng)
+{
+	population.assign(source.begin(), source.end());
+	playCompact(population, rng);
+}
+
+
+// Players still on the ground after the last turn are eliminated.
+// The distance walked so far is kept in the per-game state bits.
+// Players never interact, so a large population is split into chunks that
+// play every turn independently, each with its own random stream.
+void RedLightGreenLight::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	// Light phases: caught and timed-out players are marked as they go out.
+	// The whole field shares one timeline, so it runs as a single event
+	// loop without the sampler or the scheduler.
+	if (compactLights.getOptions().enabled)
+	{
+		struct Listener
+		{
+			Population& population;
+
+			unsigned int speed(size_t i)
+			{
+				const CompactPlayer& p = population[i];
+				return PlayerRLGL::movingDistance(p.getNumber(), p.getAgility(), p.getFearlessness());
+			}
+			void light(const LightEvent&) {}
+			void escape(size_t, unsigned int) {}
+			void caught(size_t i) { population[i].set(CompactPlayer::Marked); }
+			void timedOut(size_t i) { population[i].set(CompactPlayer::Marked); }
+		};
+
+		Listener listener{ population };
+		compactLights.run(population, turn, distance, rng, listener);
+
+		population.erase(std::remove_if(population.begin(), population.end(),
+			[](const CompactPlayer& p) { return p.has(CompactPlayer::Marked); }), population.end());
+
+		survivor_count = population.size();
+		death_count = initial_count - survivor_count;
+		return;
+	}
+
+	auto playTurns = [this](CompactPlayer* first, CompactPlayer* last, RandomBuffer& rng) {
+		for (CompactPlayer* p = first; p != last; ++p)
+		{
+			p->set(CompactPlayer::Playing);
+			p->setState(0);
+		}
+
+		for (unsigned int t = 0; t < turn; ++t)
+			playTurn(first, last, t, rng);
+	};
+
+	if (scheduler && !sampler && population.size() > parallelGrain)
+	{
+		uint64_t streams = (uint64_t(rng.nextWord()) << 32) | rng.nextWord();
+		CompactPlayer* base = population.data();
+
+		scheduler->parallelFor(0, population.size(), parallelGrain, [&](size_t first, size_t last) {
+			RandomBuffer chunkRng(streams + first / parallelGrain);
+			playTurns(base + first, base + last, chunkRng);
+		});
+	}
+	else
+		playTurns(population.data(), population.data() + population.size(), rng);
+
+	population.erase(std::remove_if(population.begin(), population.end(),
+		[](const CompactPlayer& p) { return p.has(CompactPlayer::Playing); }), population.end());
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+
+// Turn t for the players in [first, last)
+void RedLightGreenLight::playTurn(CompactPlayer* first, CompactPlayer* last, unsigned int t, RandomBuffer& rng)
+{
+	for (CompactPlayer* p = first; p != last; ++p)
+	{
+		if (!p->has(CompactPlayer::Playing))
+			continue;
+
+		uint64_t current_distance = p->getState() + uint64_t(PlayerRLGL::movingDistance(p->getNumber(), p->getAgility(), p->getFearlessness()));
+
+		// Escaped, or fell down; either way the player stops acting.
+		// Only players still on the ground at the end die, so a sampled target
+		// that cannot escape in the turns left survives only by falling in one
+		// of them, and when it falls does not matter.
+		bool fell;
+		if (sampler && sampler->isTarget(*p) && p->getState() + uint64_t(turn - t) * (current_distance - p->getState()) < distance)
+			fell = sampler->survive(1.0f - std::pow(1.0f - fallDownRate, float(turn - t)));
+		else
+			fell = rng.nextChance(fallThreshold);
+
+		if (current_distance >= distance || fell)
+			p->clear(CompactPlayer::Playing);
+		else
+			p->setState(static_cast<unsigned int>(current_distance));
+	}
+}
+
+
+// One match for one player; non-tie matches are won half the time
+bool RPS::loses(const CompactPlayer& p, RandomBuffer& rng) const
+{
+	if (sampler && sampler->isTarget(p))
+		return !sampler->survive(0.5f);
+
+	PlayerRPS::rpsType myRPS, yourRPS;
+	do {
+		myRPS = PlayerRPS::choose(rng.nextProbability());
+		yourRPS = PlayerRPS::choose(rng.nextProbability());
+	}
+	while (myRPS == yourRPS);
+
+	return !PlayerRPS::beats(myRPS, yourRPS);
+}
+
+// Every player plays one match; losers are removed in a single sweep.
+// Large populations resolve their matches in parallel chunks first.
+void RPS::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	if (population.size() < 2)
+		return;
+
+	if (scheduler && !sampler && population.size() > parallelGrain)
+	{
+		uint64_t streams = (uint64_t(rng.nextWord()) << 32) | rng.nextWord();
+
+		scheduler->parallelFor(0, population.size(), parallelGrain, [&](size_t first, size_t last) {
+			RandomBuffer chunkRng(streams + first / parallelGrain);
+			for (size_t i = first; i < last; ++i)
+			{
+				if (loses(population[i], chunkRng))
+					population[i].set(CompactPlayer::Marked);
+				else
+					population[i].clear(CompactPlayer::Marked);
+			}
+		});
+
+		population.erase(std::remove_if(population.begin(), population.end(),
+			[](const CompactPlayer& p) { return p.has(CompactPlayer::Marked); }), population.end());
+	}
+	else
+	{
+		population.erase(std::remove_if(population.begin(), population.end(),
+			[&](const CompactPlayer& p) { return loses(p, rng); }), population.end());
+	}
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+// Matches in order, as the serial playCompact() plays them, copying the
+// winners; the parallel path marks players, so it plays on a copy
+void RPS::playCompactFrom(const Population& source, Population& population, RandomBuffer& rng)
+{
+	if (source.size() < 2 || (scheduler && !sampler && source.size() > parallelGrain))
+		return Game::playCompactFrom(source, population, rng);
+
+	initial_count = source.size();
+	population.clear();
+	std::remove_copy_if(source.begin(), source.end(), std::back_inserter(population),
+		[&](const CompactPlayer& p) { return loses(p, rng); });
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+
+// Even positions form team 1, odd positions team 2.
+// Powers are summed in 64 bits so very large populations cannot overflow.
+// The survivors of every round are every stride-th player from first, so
+// rounds sum them where they stand and the population is compacted once
+// at the end. Rotate and Swap rearrange each round's line-up instead, so
+// they keep the winners in place after every round.
+void TugOfWar::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	if (population.size() < 2)
+		return;
+
+	if (options.split != RopeOptions::Alternate)
+	{
+		for (unsigned int round = 0; round < options.rounds && population.size() >= 2; ++round)
+		{
+			int losingTeam = arrangeRope(population.data(), population.size(), options, column, rng).getLosingTeam();
+			if (losingTeam < 0)
+				break;
+
+			size_t alive = 0;
+			for (size_t i = 1 - losingTeam; i < population.size(); i += 2)
+				population[alive++] = population[i];
+			population.resize(alive);
+		}
+
+		survivor_count = population.size();
+		death_count = initial_count - survivor_count;
+		return;
+	}
+
+	size_t first = 0;
+	size_t stride = playRounds(population, first);
+	if (stride > 1)
+	{
+		size_t alive = 0;
+		for (size_t i = first; i < population.size(); i += stride)
+			population[alive++] = population[i];
+		population.resize(alive);
+	}
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+// Decides every round without moving anyone; the survivors are then
+// players first, first + stride, ... where stride is returned
+size_t TugOfWar::playRounds(const Population& population, size_t& first)
+{
+	first = 0;
+	size_t stride = 1;
+	size_t left = population.size();
+
+	for (unsigned int round = 0; round < options.rounds && left >= 2; ++round)
+	{
+		int losingTeam = splitStrided(population.data(), population.size(), first, stride).getLosingTeam();
+		if (losingTeam < 0)
+			break;
+
+		first += (1 - losingTeam) * stride;
+		stride *= 2;
+		left = (population.size() - first + stride - 1) / stride;
+	}
+	return stride;
+}
+
+void TugOfWar::playCompactFrom(const Population& source, Population& population, RandomBuffer& rng)
+{
+	if (source.size() < 2 || options.split != RopeOptions::Alternate)
+		return Game::playCompactFrom(source, population, rng);
+
+	initial_count = source.size();
+	size_t first = 0;
+	size_t stride = playRounds(source, first);
+
+	population.clear();
+	for (size_t i = first; i < source.size(); i += stride)
+		population.push_back(source[i]);
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+
+// The player at the front keeps stepping until they fall,
+// so the dead are always a prefix of the population
+void GlassBridge::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	if (population.size() < 1)
+		return;
+
+	population.erase(population.begin(), population.begin() + cross(population, rng));
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+// Plays the bridge and returns how many players fell
+size_t GlassBridge::cross(const Population& population, RandomBuffer& rng)
+{
+	bool safeGlass[totalSteps];
+	for (int i = 0; i < totalSteps; ++i)
+		safeGlass[i] = (rng.nextProbability() < 0.5f);
+
+	int currentStep = 0;
+	size_t fallen = 0;
+
+	while (fallen < population.size() && currentStep < totalSteps)
+	{
+		bool chooseCorrect;
+		if (sampler && sampler->isTarget(population[fallen]))
+			chooseCorrect = sampler->survive(0.5f);
+		else
+			chooseCorrect = (rng.nextProbability() < 0.5f) == safeGlass[currentStep];
+
+		if (chooseCorrect)
+			currentStep++;
+		else
+			fallen++;
+	}
+
+	step_count = currentStep;
+	return fallen;
+}
+
+void GlassBridge::playCompactFrom(const Population& source, Population& population, RandomBuffer& rng)
+{
+	if (source.size() < 1)
+		return Game::playCompactFrom(source, population, rng);
+
+	initial_count = source.size();
+	population.assign(source.begin() + cross(source, rng), source.end());
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+
+// Rounds run on the bracket: by default one round of pairs (0,1), (2,3), ...
+// with a bye for the last player of an odd count, who is placed first as
+// play() does. Large rounds play their matches as parallel tasks unless a
+// sampler needs every draw in order.
+void Marbles::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	if (population.size() < 2)
+		return;
+
+	compactBracket.reset();
+	while (compactBracket.hasNextRound(population.size()))
+		playRound(population, rng);
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+// One bracket round: seed it, play every match and keep the winners
+void Marbles::playRound(Population& population, RandomBuffer& rng)
+{
+	auto match = [this](const CompactPlayer& player1, const CompactPlayer& player2, RandomBuffer& random) {
+		int marbles2 = static_cast<int>(random.nextProbability() * 10) + 1;
+
+		bool isOdd = (marbles2 % 2 == 1);
+		bool guessOdd = (random.nextProbability() < 0.5f);
+		bool firstWins = (guessOdd == isOdd);
+
+		// The guess is right half the time whatever isOdd is
+		if (sampler && (sampler->isTarget(player1) || sampler->isTarget(player2)))
+			firstWins = sampler->survive(0.5f) == sampler->isTarget(player1);
+
+		return firstWins;
+	};
+
+	compactBracket.seedRound(population, rng, sampler ? nullptr : scheduler);
+	compactBracket.playMatches(population, match, rng, sampler ? nullptr : scheduler, parallelGrain);
+	compactBracket.advance(population);
+}
+
+
+// Same bracket as Marbles; higher power wins, ties are random
+void Ddakji::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	if (population.size() < 2)
+		return;
+
+	compactBracket.reset();
+	while (compactBracket.hasNextRound(population.size()))
+		playRound(population, rng);
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+// One bracket round, as in Marbles
+void Ddakji::playRound(Population& population, RandomBuffer& rng)
+{
+	auto match = [this](const CompactPlayer& player1, const CompactPlayer& player2, RandomBuffer& random) {
+		if (player1.getPower() != player2.getPower())
+			return player1.getPower() > player2.getPower();
+		if (sampler && (sampler->isTarget(player1) || sampler->isTarget(player2)))
+			return sampler->survive(0.5f) == sampler->isTarget(player1);
+		return random.nextProbability() < 0.5f;
+	};
+
+	compactBracket.seedRound(population, rng, sampler ? nullptr : scheduler);
+	compactBracket.playMatches(population, match, rng, sampler ? nullptr : scheduler, parallelGrain);
+	compactBracket.advance(population);
+}
+
+
+void Pysical_Asia_ship::reserve(size_t playerCount, int)
+{
+	taskTimes.reserve(playerCount);
+	ranked.reserve(playerCount);
+}
+
+
+// Rounds repeat until two players are left.
+// Only the survivors need to be sorted, so the rest is split off with nth_element.
+void Pysical_Asia_ship::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+	round_count = 0;
+
+	if (population.size() < 3)
+	{
+		survivor_count = population.size();
+		death_count = initial_count - survivor_count;
+		return;
+	}
+
+	while (population.size() > 2)
+		playRound(population, rng);
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+// The first round reads source; its survivors are the first copy
+void Pysical_Asia_ship::playCompactFrom(const Population& source, Population& population, RandomBuffer& rng)
+{
+	if (source.size() < 3)
+		return Game::playCompactFrom(source, population, rng);
+
+	initial_count = source.size();
+	round_count = 0;
+
+	playRound(source, population, rng);
+	while (population.size() > 2)
+		playRound(population, rng);
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+
+// One round: the fastest half (at least two) of source survive into
+// population, ordered by task time. source may be population itself.
+void Pysical_Asia_ship::playRound(const Population& source, Population& population, RandomBuffer& rng)
+{
+	auto byTime = [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+		return a.first < b.first;
+	};
+
+	size_t surviveCount = source.size() / 2;
+	if (surviveCount < 2) surviveCount = 2;
+
+	size_t target = source.size();
+	taskTimes.resize(source.size());
+	for (size_t i = 0; i < source.size(); ++i)
+	{
+		const CompactPlayer& p = source[i];
+		if (sampler && sampler->isTarget(p))
+			target = i;
+		else
+			taskTimes[i] = { PlayerShip::taskTime(p.getAgility(), p.getFearlessness(), rng.nextProbability()), uint32_t(i) };
+	}
+
+	// A sampled target survives when it beats the surviveCount-th fastest
+	// of the others; draw its noise from the part of [0, 1) that does
+	if (target < source.size())
+	{
+		taskTimes[target] = { INFINITY, uint32_t(target) };
+		std::nth_element(taskTimes.begin(), taskTimes.begin() + (surviveCount - 1), taskTimes.end(), byTime);
+		float cutoff = taskTimes[surviveCount - 1].first;
+
+		const CompactPlayer& p = source[target];
+		float slowest = PlayerShip::taskTime(p.getAgility(), p.getFearlessness(), 1.0f);
+		float fastest = PlayerShip::taskTime(p.getAgility(), p.getFearlessness(), 0.0f);
+		float limit = (cutoff - fastest) / (slowest - fastest);
+
+		for (auto& entry : taskTimes)
+		{
+			if (entry.second == target)
+				entry.first = PlayerShip::taskTime(p.getAgility(), p.getFearlessness(), sampler->drawBelow(rng, limit));
+		}
+	}
+
+	std::nth_element(taskTimes.begin(), taskTimes.begin() + surviveCount, taskTimes.end(), byTime);
+	std::sort(taskTimes.begin(), taskTimes.begin() + surviveCount, byTime);
+
+	ranked.resize(surviveCount);
+	for (size_t i = 0; i < surviveCount; ++i)
+		ranked[i] = source[taskTimes[i].second];
+
+	population.swap(ranked);
+	round_count++;
+}
+
+
+// Rounds repeat until at most one player is left; that player is the winner
+void SquidGame::playCompact(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+	compact_winner = CompactPlayer();
+
+	if (population.size() < 2)
+		return;
+
+	while (population.size() > 1)
+		playRound(population, rng);
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+
+	if (survivor_count == 1)
+		compact_winner = population.front();
+}
+
+// The first round reads source; its survivors are the first copy
+void SquidGame::playCompactFrom(const Population& source, Population& population, RandomBuffer& rng)
+{
+	if (source.size() < 2)
+		return Game::playCompactFrom(source, population, rng);
+
+	initial_count = source.size();
+	compact_winner = CompactPlayer();
+
+	playRound(source, population, rng);
+	while (population.size() > 1)
+		playRound(population, rng);
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+
+	if (survivor_count == 1)
+		compact_winner = population.front();
+}
+
+// One confrontation: the player attacks or defends and fails their roll or survives
+bool SquidGame::loses(const CompactPlayer& p, RandomBuffer& rng) const
+{
+	bool isAttack = rng.nextChance(attackThreshold);
+
+	// The target always survives, everyone else less often
+	if (sampler)
+	{
+		float successProb = PlayerSquidGame::successProbability(p.getAgility(), p.getFearlessness(), isAttack);
+		return sampler->isTarget(p) ? !sampler->survive(successProb) : !sampler->drawAvoiding(rng, successProb);
+	}
+
+	return !rng.nextChance(PlayerSquidGame::successThreshold(p.getAgility(), p.getFearlessness(), isAttack));
+}
+
+// One round: the survivors of source are left in population, which may be source itself
+void SquidGame::playRound(const Population& source, Population& population, RandomBuffer& rng)
+{
+	auto lost = [&](const CompactPlayer& p) { return loses(p, rng); };
+
+	if (&source == &population)
+		population.erase(std::remove_if(population.begin(), population.end(), lost), population.end());
+	else
+	{
+		population.clear();
+		std::remove_copy_if(source.begin(), source.end(), std::back_inserter(population), lost);
+	}
+}
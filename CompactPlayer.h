@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Numa.h"
+
+// Packed 8-byte player record for very large populations.
+// The second word holds agility (bits 0-6), fearlessness (bits 7-13),
+// status flags (bits 14-17) and 14 bits of per-game state (bits 18-31).
+class CompactPlayer
+{
+public:
+	enum Flag : uint32_t
+	{
+		Playing = 1u << 14,	// still acting in the current game (RLGL)
+		Marked = 1u << 15,	// lost this round, removed by the next sweep
+	};
+
+	static const uint32_t maxState = (1u << 14) - 1;
+
+	CompactPlayer() {};
+	CompactPlayer(uint32_t number, unsigned int agility, unsigned int fearlessness)
+		: number(number), bits((agility & 0x7F) | ((fearlessness & 0x7F) << 7)) {};
+
+	int getNumber() const { return number; }
+	int getAgility() const { return bits & 0x7F; }
+	int getFearlessness() const { return (bits >> 7) & 0x7F; }
+	int getPower() const { return getAgility() + getFearlessness(); }
+
+	bool has(Flag flag) const { return (bits & flag) != 0; }
+	void set(Flag flag) { bits |= flag; }
+	void clear(Flag flag) { bits &= ~uint32_t(flag); }
+
+	// Scratch value owned by the game currently being played
+	unsigned int getState() const { return bits >> 18; }
+	void setState(unsigned int state) { bits = (bits & 0x3FFFF) | (state << 18); }
+
+private:
+	uint32_t number = 0;
+	uint32_t bits = 0;
+};
+
+static_assert(sizeof(CompactPlayer) == 8, "CompactPlayer must stay 8 bytes");
+
+// Flat array of players; games keep survivors in place and shrink it.
+// Large populations live in the arena of the node that allocated them.
+typedef std::vector<CompactPlayer, NodeAllocator<CompactPlayer>> Population;
@@ -0,0 +1,75 @@
+#include "Coroutine.h"
+
+#ifdef __cpp_impl_coroutine
+#include <new>
+
+namespace
+{
+	// A few free lists, one per frame size seen on this thread.
+	// Games have a handful of frame sizes, so a short array is enough;
+	// sizes beyond it go straight to the heap.
+	struct FrameLists
+	{
+		static const size_t slots = 16;
+
+		struct Node { Node* next; };
+
+		size_t sizes[slots] = {};
+		Node* heads[slots] = {};
+
+		~FrameLists()
+		{
+			for (size_t s = 0; s < slots; ++s)
+			{
+				while (Node* node = heads[s])
+				{
+					heads[s] = node->next;
+					::operator delete(node);
+				}
+			}
+		}
+
+		Node** find(size_t size, bool add)
+		{
+			for (size_t s = 0; s < slots; ++s)
+			{
+				if (sizes[s] == size)
+					return &heads[s];
+				if (sizes[s] == 0 && add)
+				{
+					sizes[s] = size;
+					return &heads[s];
+				}
+			}
+			return nullptr;
+		}
+	};
+
+	thread_local FrameLists frameLists;
+}
+
+void* FramePool::allocate(size_t size)
+{
+	FrameLists::Node** head = frameLists.find(size, false);
+	if (head && *head)
+	{
+		FrameLists::Node* node = *head;
+		*head = node->next;
+		return node;
+	}
+	return ::operator new(size < sizeof(FrameLists::Node) ? sizeof(FrameLists::Node) : size);
+}
+
+void FramePool::release(void* frame, size_t size)
+{
+	FrameLists::Node** head = frameLists.find(size, true);
+	if (!head)
+	{
+		::operator delete(frame);
+		return;
+	}
+	FrameLists::Node* node = static_cast<FrameLists::Node*>(frame);
+	node->next = *head;
+	*head = node;
+}
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+// Coroutine forms of the games need C++20 coroutines; without them
+// everything here is left out and only the blocking forms exist.
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+// Recycles coroutine frames on the thread that frees them, so games
+// started over and over on a thread stop allocating once warmed up
+class FramePool
+{
+public:
+	static void* allocate(size_t size);
+	static void release(void* frame, size_t size);
+};
+
+// A compact game played one round at a time.
+// The coroutine suspends before its first round and at every round
+// boundary; resume() plays up to the next one. Destroying an unfinished
+// GameSteps cancels the game, leaving the population as of its last
+// completed round.
+class GameSteps
+{
+public:
+	struct promise_type
+	{
+		unsigned int rounds = 0;
+		std::exception_ptr exception;
+
+		GameSteps get_return_object() { return GameSteps(std::coroutine_handle<promise_type>::from_promise(*this)); }
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		std::suspend_always yield_value(unsigned int round) noexcept { rounds = round; return {}; }
+		void return_void() {}
+		void unhandled_exception() { exception = std::current_exception(); }
+
+		static void* operator new(size_t size) { return FramePool::allocate(size); }
+		static void operator delete(void* frame, size_t size) { FramePool::release(frame, size); }
+	};
+
+	GameSteps() {};
+	GameSteps(GameSteps&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {};
+	GameSteps& operator=(GameSteps&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (handle)
+				handle.destroy();
+			handle = std::exchange(other.handle, nullptr);
+		}
+		return *this;
+	}
+	~GameSteps() { if (handle) handle.destroy(); };
+
+	// Plays up to the next round boundary; false once the game is over
+	bool resume()
+	{
+		if (!handle || handle.done())
+			return false;
+		handle.resume();
+		if (handle.promise().exception)
+			std::rethrow_exception(handle.promise().exception);
+		return !handle.done();
+	}
+
+	bool isDone() const { return !handle || handle.done(); }
+
+	// Rounds completed so far
+	unsigned int getRounds() const { return handle ? handle.promise().rounds : 0; }
+
+private:
+	explicit GameSteps(std::coroutine_handle<promise_type> handle) : handle(handle) {};
+
+	std::coroutine_handle<promise_type> handle;
+};
+#endif
@@ -0,0 +1,179 @@
+#include <charconv>
+#include <cstring>
+#include "Export.h"
+
+namespace
+{
+	struct Column
+	{
+		const char* name;
+		uint32_t width;
+	};
+
+	const Column layout[] = {
+		{ "run", 8 },
+		{ "game", 1 },
+		{ "initial", 4 },
+		{ "survivors", 4 },
+		{ "deaths", 4 },
+		{ "winner", 4 },
+		{ "winner_agility", 1 },
+		{ "winner_fearlessness", 1 },
+		{ "glass_steps", 2 },
+		{ "ship_rounds", 2 },
+	};
+
+	const size_t columnCount = sizeof(layout) / sizeof(layout[0]);
+
+	void appendLittle(std::vector<uint8_t>& out, uint64_t value, size_t width)
+	{
+		for (size_t i = 0; i < width; ++i)
+			out.push_back(uint8_t(value >> (8 * i)));
+	}
+
+	void appendNumber(std::string& out, uint64_t value, char separator)
+	{
+		char digits[24];
+		char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+		out.append(digits, end);
+		out.push_back(separator);
+	}
+}
+
+ResultWriter::ResultWriter(const std::string& path, Format format, const std::vector<std::string>& gameNames)
+	: format(format), gameNames(gameNames)
+{
+	file = fopen(path.c_str(), format == Csv ? "w" : "wb");
+	if (!file)
+		return;
+
+	if (format == Csv)
+	{
+		std::string header;
+		for (size_t c = 0; c < columnCount; ++c)
+		{
+			header += layout[c].name;
+			header += (c + 1 < columnCount) ? ',' : '\n';
+		}
+		fwrite(header.data(), 1, header.size(), file);
+		return;
+	}
+
+	std::vector<uint8_t> header;
+	header.insert(header.end(), "SQUIDCOL", "SQUIDCOL" + 8);
+	appendLittle(header, 1, 4);
+	appendLittle(header, gameNames.size(), 4);
+	appendLittle(header, columnCount, 4);
+	for (auto& name : gameNames)
+	{
+		appendLittle(header, name.size(), 4);
+		header.insert(header.end(), name.begin(), name.end());
+	}
+	for (size_t c = 0; c < columnCount; ++c)
+	{
+		char name[24] = {};
+		strncpy(name, layout[c].name, sizeof(name) - 1);
+		header.insert(header.end(), name, name + sizeof(name));
+		appendLittle(header, layout[c].width, 4);
+	}
+	fwrite(header.data(), 1, header.size(), file);
+}
+
+ResultWriter::~ResultWriter()
+{
+	if (file)
+		fclose(file);
+}
+
+// Blocks are written whole, so a block never interleaves with another
+void ResultWriter::write(const void* data, size_t bytes, size_t rows)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if (!file)
+		return;
+	fwrite(data, 1, bytes, file);
+	rowCount += rows;
+}
+
+
+ResultWriter::Buffer::Buffer(ResultWriter& writer)
+	: writer(writer), columns(columnCount)
+{
+	if (writer.format == Csv)
+		text.reserve(textBlock + 4096);
+	else
+	{
+		for (size_t c = 0; c < columnCount; ++c)
+			columns[c].reserve(blockRows * layout[c].width);
+	}
+}
+
+ResultWriter::Buffer::~Buffer()
+{
+	flush();
+}
+
+void ResultWriter::Buffer::add(uint64_t run, const std::vector<GameRecord>& records)
+{
+	for (size_t g = 0; g < records.size(); ++g)
+	{
+		const GameRecord& record = records[g];
+		uint64_t values[columnCount] = {
+			run, g,
+			record.initial_count, record.survivor_count, record.death_count,
+			uint64_t(record.winner.getNumber()),
+			uint64_t(record.winner.getAgility()), uint64_t(record.winner.getFearlessness()),
+			record.step_count, record.round_count,
+		};
+
+		if (writer.format == Csv)
+		{
+			for (size_t c = 0; c < columnCount; ++c)
+			{
+				char separator = (c + 1 < columnCount) ? ',' : '\n';
+				if (c == 1 && g < writer.gameNames.size())
+				{
+					text += writer.gameNames[g];
+					text.push_back(separator);
+				}
+				else
+					appendNumber(text, values[c], separator);
+			}
+		}
+		else
+		{
+			for (size_t c = 0; c < columnCount; ++c)
+				appendLittle(columns[c], values[c], layout[c].width);
+		}
+
+		rows++;
+		if ((writer.format == Csv && text.size() >= textBlock) || (writer.format == Columnar && rows >= blockRows))
+			flush();
+	}
+}
+
+void ResultWriter::Buffer::flush()
+{
+	if (rows == 0)
+		return;
+
+	if (writer.format == Csv)
+	{
+		writer.write(text.data(), text.size(), rows);
+		text.clear();
+	}
+	else
+	{
+		block.clear();
+		appendLittle(block, rows, 4);
+		appendLittle(block, 0, 4);
+		for (auto& column : columns)
+		{
+			block.insert(block.end(), column.begin(), column.end());
+			column.clear();
+		}
+		writer.write(block.data(), block.size(), rows);
+	}
+
+	rows = 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Tournament.h"
+
+// Writes one row per (run, game) to a file, either as column blocks or CSV.
+//
+// Columnar layout, little-endian on every host since each value is
+// written byte by byte:
+//   "SQUIDCOL", uint32 version, uint32 game count, uint32 column count,
+//   per game: uint32 name length + name bytes,
+//   per column: char name[24] + uint32 width in bytes,
+//   then blocks: uint32 row count, uint32 reserved, and each column's
+//   values for those rows stored back to back.
+// A reader maps the file and gets every column of a block as a plain array.
+//
+// Threads append through their own Buffer, which hands the writer one
+// large block at a time; blocks from different threads may interleave,
+// so the run column identifies each row.
+class ResultWriter
+{
+public:
+	enum Format
+	{
+		Columnar,
+		Csv
+	};
+
+	class Buffer
+	{
+		ResultWriter& writer;
+		std::vector<std::vector<uint8_t>> columns;
+		std::vector<uint8_t> block;
+		std::string text;
+		size_t rows = 0;
+	public:
+		Buffer(ResultWriter& writer);
+		~Buffer();
+
+		// Appends one row per game of a finished run
+		void add(uint64_t run, const std::vector<GameRecord>& records);
+		void flush();
+	};
+
+	// Rows per columnar block, and bytes of CSV text per write
+	static const size_t blockRows = 1 << 16;
+	static const size_t textBlock = 1 << 22;
+
+	ResultWriter(const std::string& path, Format format, const std::vector<std::string>& gameNames);
+	~ResultWriter();
+
+	bool isOpen() const { return file != nullptr; }
+	Format getFormat() const { return format; }
+	uint64_t getRowCount() const { return rowCount; }
+
+private:
+	FILE* file = nullptr;
+	Format format;
+	std::vector<std::string> gameNames;
+	std::mutex lock;
+	uint64_t rowCount = 0;
+
+	void write(const void* data, size_t bytes, size_t rows);
+};
@@ -1,8 +1,27 @@
 ﻿#include <iostream>
 #include <algorithm>
+#include <cstdio>
+#include <typeinfo>
 #include "Game.h"
 #include "Player.h"
 
+namespace
+{
+	// True when every player in the segment is exactly a T. The batch
+	// paths below stand in for T::act(), so players of a subclass that
+	// overrides act() go through Game::actAll() instead.
+	template <class T>
+	bool allExactly(Player* const* first, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (typeid(*first[i]) != typeid(T))
+				return false;
+		}
+		return true;
+	}
+}
+
 
 // Destructor: releases all dynamically allocated Player objects
 Game::~Game()
@@ -14,10 +33,73 @@ Game::~Game()
 	players.clear();
 }
 
+// Clears the statistics so the same game object can be played again
+void Game::resetStats()
+{
+	initial_count = 0;
+	survivor_count = 0;
+	death_count = 0;
+	winner = nullptr;
+	compact_winner = CompactPlayer();
+	step_count = 0;
+	round_count = 0;
+	summary_death_rate = -1.0f;
+}
+
+// Replaces the statistics with results merged from elsewhere
+void Game::setSummary(unsigned int initial, unsigned int survivors, unsigned int deaths, const CompactPlayer& winner, float deathRate)
+{
+	resetStats();
+	initial_count = initial;
+	survivor_count = survivors;
+	death_count = deaths;
+	compact_winner = winner;
+	summary_death_rate = deathRate;
+}
+
 // Prints the name of the current game
 void Game::printGameName()
 {
-	std::cout << "[[[" << gameName << "]]]" << std::endl;
+	TextOut::standard() << "[[[" << gameName << "]]]" << '\n';
+}
+
+// Default batch act: falls back to calling act() on every player
+void Game::actAll(Player* const* first, size_t count, std::vector<uint64_t>& results)
+{
+	results.assign((count + 63) / 64, 0);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (first[i]->act())
+			results[i / 64] |= uint64_t(1) << (i % 64);
+	}
+}
+
+// Runs actAll() over every current player, in order.
+// The outcome of the i-th player is actResult(batchResults, i).
+void Game::actPlayers()
+{
+	actAll(players.data(), players.size(), batchResults);
+}
+
+void Game::eliminate(size_t index)
+{
+	players[index]->dyingMessage();
+	eliminated.push_back(players[index]);
+	players[index] = nullptr;
+}
+
+// Survivors keep their order; returns the number of players removed
+size_t Game::sweepEliminated()
+{
+	players.erase(std::remove(players.begin(), players.end(), nullptr), players.end());
+
+	for (auto player : eliminated)
+		delete player;
+
+	size_t count = eliminated.size();
+	eliminated.clear();
+	return count;
 }
 
 // Prints status messages of all surviving players
@@ -35,6 +117,23 @@ const unsigned int RedLightGreenLight::distance = 1000;
 
 // Probability of falling down while moving
 const float RedLightGreenLight::fallDownRate = 0.1f;
+const uint32_t RedLightGreenLight::fallThreshold = RandomBuffer::threshold(fallDownRate);
+
+// Rates are written as hex floats so every bit of them is part of the text
+std::string RedLightGreenLight::getParameters() const
+{
+	const LightOptions& options = lights.getOptions();
+	char text[200];
+	snprintf(text, sizeof(text), "turn=%u distance=%u fallDownRate=%a lights=%d", turn, distance, double(fallDownRate), int(options.enabled));
+	std::string parameters = text;
+	if (options.enabled)
+	{
+		snprintf(text, sizeof(text), " green=%u-%u red=%u-%u lookDelay=%u",
+			options.greenMin, options.greenMax, options.redMin, options.redMax, options.lookDelay);
+		parameters += text;
+	}
+	return parameters;
+}
 
 
 // Adds a player to Red Light Green Light game
@@ -44,6 +143,68 @@ void RedLightGreenLight::join(Player* player)
 	players.push_back(new PlayerRLGL(*player));
 }
 
+// Moves every player in the segment once, drawing all fall-down rolls together
+void RedLightGreenLight::actAll(Player* const* first, size_t count, std::vector<uint64_t>& results)
+{
+	if (!allExactly<PlayerRLGL>(first, count))
+		return Game::actAll(first, count, results);
+
+	batchRolls.resize(count);
+	Player::getRandomProbabilities(batchRolls.data(), count);
+
+	results.assign((count + 63) / 64, 0);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (static_cast<PlayerRLGL*>(first[i])->act(batchRolls[i]))
+			results[i / 64] |= uint64_t(1) << (i % 64);
+	}
+}
+
+// Plays the light phases as events, printing each light change.
+// Players are eliminated as the doll catches them, and those still on
+// the ground when the last red light ends after it.
+void RedLightGreenLight::playLights()
+{
+	struct Listener
+	{
+		RedLightGreenLight& game;
+
+		unsigned int speed(size_t i)
+		{
+			Player* player = game.players[i];
+			return PlayerRLGL::movingDistance(player->getNumber(), player->getAgility(), player->getFearlessness());
+		}
+		void light(const LightEvent& event)
+		{
+			if (event.type == LightEvent::Green)
+				TextOut::standard() << "[Green Light]" << '\n';
+			else if (event.type == LightEvent::Red)
+				TextOut::standard() << "[Red Light]" << '\n';
+			else if (event.type == LightEvent::Look)
+				TextOut::standard() << "The doll turns around." << '\n';
+			else if (event.type == LightEvent::End)
+				TextOut::standard() << "[Game Over]" << '\n';
+		}
+		void escape(size_t i, unsigned int distance)
+		{
+			static_cast<PlayerRLGL*>(game.players[i])->escape(distance);
+		}
+		void caught(size_t i)
+		{
+			static_cast<PlayerRLGL*>(game.players[i])->setCaught();
+			game.eliminate(i);
+		}
+		void timedOut(size_t i)
+		{
+			game.eliminate(i);
+		}
+	};
+
+	Listener listener{ *this };
+	lights.run(players, turn, distance, Player::getRandomBuffer(), listener);
+}
+
 // Executes the Red Light Green Light game
 // Players move for a fixed number of turns.
 // After all turns, players who have not escaped are eliminated.
@@ -52,50 +213,47 @@ void RedLightGreenLight::play()
 	printGameName();
 
     initial_count = players.size();
-	std::cout << initial_count << " players joined the game." << std::endl;
-
-	// Each turn, only players who are still playing can act.
-	// Players who fall down or fail to advance stop playing immediately.
+	TextOut::standard() << initial_count << " players joined the game." << '\n';
 
-	for (int t = 0; t < turn; ++t) // 10이 아닐때까지
+	if (lights.getOptions().enabled)
+		playLights();
+	else
 	{
+		// Each turn, only players who are still playing can act.
+		// Players who fall down or fail to advance stop playing immediately.
 
-		for(auto player = players.begin(); player != players.end(); ++player){
-
-			if ((*player) -> isPlaying()){
+		for (int t = 0; t < turn; ++t) // 10이 아닐때까지
+		{
+			batch.clear();
 
-				(*player) -> act();
+			for (auto player : players)
+			{
+				if (player->isPlaying())
+					batch.push_back(player);
 			}
-		}
 
-	}
+			actAll(batch.data(), batch.size(), batchResults);
+		}
 
-	std::cout << "[Game Over]" << std::endl;
+		TextOut::standard() << "[Game Over]" << '\n';
 
-	auto player = players.begin();
-	while (player != players.end())
-	{
-		if ((*player)->isPlaying())
+		for (size_t i = 0; i < players.size(); ++i)
 		{
-			(*player)->dyingMessage();
-			delete (*player);
-			player = players.erase(player);
-		}
-		else
-		{
-			++player;
+			if (players[i]->isPlaying())
+				eliminate(i);
 		}
 	}
+	sweepEliminated();
 
 	survivor_count = players.size();
 	death_count = initial_count - survivor_count;
 
 	printAlivePlayers();
 
-	std::cout << "\n[Game Statistics]" << std::endl;
-	std::cout << "Total players: " << initial_count << std::endl;
-	std::cout << "Survivors: " << survivor_count << std::endl;
-	std::cout << "Deaths: " << death_count << std::endl << std::endl;
+	TextOut::standard() << "\n[Game Statistics]" << '\n';
+	TextOut::standard() << "Total players: " << initial_count << '\n';
+	TextOut::standard() << "Survivors: " << survivor_count << '\n';
+	TextOut::standard() << "Deaths: " << death_count << '\n' << '\n';
 }
 
 
@@ -107,6 +265,42 @@ void RPS::join(Player* player)
 	players.push_back(new PlayerRPS(*player));
 }
 
+// Plays one RPS match per player.
+// Two choices are drawn per match up front; ties reroll from a refilled pool.
+void RPS::actAll(Player* const* first, size_t count, std::vector<uint64_t>& results)
+{
+	if (!allExactly<PlayerRPS>(first, count))
+		return Game::actAll(first, count, results);
+
+	batchRolls.resize(2 * count + 64);
+	Player::getRandomProbabilities(batchRolls.data(), batchRolls.size());
+
+	size_t next = 0;
+	auto roll = [&] {
+		if (next == batchRolls.size())
+		{
+			Player::getRandomProbabilities(batchRolls.data(), batchRolls.size());
+			next = 0;
+		}
+		return batchRolls[next++];
+	};
+
+	results.assign((count + 63) / 64, 0);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		PlayerRPS::rpsType myRPS, yourRPS;
+		do {
+			myRPS = PlayerRPS::choose(roll());
+			yourRPS = PlayerRPS::choose(roll());
+		}
+		while (myRPS == yourRPS);
+
+		if (PlayerRPS::beats(myRPS, yourRPS))
+			results[i / 64] |= uint64_t(1) << (i % 64);
+	}
+}
+
 // Executes Rock Paper Scissors game
 // Players are eliminated immediately based on act() result
 void RPS::play()
@@ -114,47 +308,50 @@ void RPS::play()
 	printGameName();
 
     initial_count = players.size();
-	std::cout << initial_count << " players joined the game." << std::endl;
+	TextOut::standard() << initial_count << " players joined the game." << '\n';
 
 	if (players.size() < 2)
 	{
-		std::cout << "There are not sufficient players." << std::endl;
+		TextOut::standard() << "There are not sufficient players." << '\n';
 		return;
 	}
 
 	// In RPS, each player performs exactly one action.
 	// Players who lose are immediately eliminated in the same round.
 
-	auto player = players.begin();
+	actPlayers();
 
-	while (player != players.end())
+	for (size_t i = 0; i < players.size(); ++i)
 	{
-		if ((*player)->act())
-		{
-			++player;
-		}
-		else
-		{
-			(*player)->dyingMessage();
-			delete (*player);
-			player = players.erase(player);
-		}
+		if (!actResult(batchResults, i))
+			eliminate(i);
 	}
+	sweepEliminated();
 
 	survivor_count = players.size();
 	death_count = initial_count - survivor_count;
 
 	printAlivePlayers();
 
-	std::cout << "\n[Game Statistics]" << std::endl;
-	std::cout << "Total players: " << initial_count << std::endl;
-	std::cout << "Survivors: " << survivor_count << std::endl;
-	std::cout << "Deaths: " << death_count << std::endl << std::endl;
+	TextOut::standard() << "\n[Game Statistics]" << '\n';
+	TextOut::standard() << "Total players: " << initial_count << '\n';
+	TextOut::standard() << "Survivors: " << survivor_count << '\n';
+	TextOut::standard() << "Deaths: " << death_count << '\n' << '\n';
 }
 
 // Executes Tug of War game
 // Players are split into two teams.
 // The team with lower total power is eliminated.
+std::string TugOfWar::getParameters() const
+{
+	std::string parameters = "rounds=" + std::to_string(options.rounds);
+	if (options.split == RopeOptions::Rotate)
+		parameters += " split=rotate";
+	else if (options.split == RopeOptions::Swap)
+		parameters += " split=swap candidates=" + std::to_string(options.candidates);
+	return parameters;
+}
+
 void TugOfWar::join(Player* player)
 {
 	players.push_back(new PlayerTOW(*player));
@@ -165,94 +362,89 @@ void TugOfWar::play(){
 	printGameName();
 
     initial_count = players.size();
-	std::cout << initial_count << " players joined the game." << std::endl;
+	TextOut::standard() << initial_count << " players joined the game." << '\n';
 
 	if (players.size() < 2) {
-		std::cout << "There are not sufficient players." << std::endl;
+		TextOut::standard() << "There are not sufficient players." << '\n';
 		return;
 	}
 
 
-	// Players are alternately assigned to two teams.
+	// Players are alternately assigned to two teams:
+	// even positions form team 1 and odd positions team 2.
 	// Team assignment does not depend on player attributes.
-	std::list<Player*> team1, team2;
-
-	int count = 0;
-	for(auto player : players)
-	{
-		if (count % 2 == 0)
-			team1.push_back(player);
-		else 
-			team2.push_back(player);
-
-		count ++;
-			
-
-	}
 
 	// Team power is calculated as the sum of (agility + fearlessness).
 	// The team with lower total power is completely eliminated.
-	int team1_power = 0;
-	int team2_power = 0;
-
-	for (auto player : team1){
-		team1_power += player->getPower();
-	}
+	// Later rounds split the survivors the same way; they are still every
+	// stride-th player of the line-up, so they are summed where they stand.
+	// Rotate and Swap first line the round's players up as the most even
+	// candidate split, then sweep the losers so the next round starts over.
+	size_t first = 0;
+	size_t stride = 1;
+	size_t left = players.size();
+	bool arranged = options.split != RopeOptions::Alternate;
+
+	for (unsigned int round = 1; round <= options.rounds && left >= 2; ++round){
+		if (options.rounds > 1)
+			TextOut::standard() << "Round " << round << '\n';
+
+		TeamPowers teams = arranged ? arrangeRope(players.data(), players.size(), options, column, Player::getRandomBuffer())
+			: splitStrided(players.data(), players.size(), first, stride);
+		int losingTeam = teams.getLosingTeam();
+		if (losingTeam == 0)
+			TextOut::standard() << "Team 1 lost" << '\n';
+		else if (losingTeam == 1)
+			TextOut::standard() << "Team 2 lost" << '\n';
+		else
+			TextOut::standard() << "It's a tie ! Both teams survive." << '\n';
+		// If both teams have equal power, no players are eliminated.
 
-	for (auto player : team2){
-		team2_power += player->getPower();
-	}
+		if (losingTeam >= 0){
+			for (size_t i = first + losingTeam * stride; i < players.size(); i += 2 * stride)
+				eliminate(i);
 
-	std::list<Player*>* losingTeam;
-	if (team1_power > team2_power){
-		std::cout << "Team 2 lost" << std::endl;
-		losingTeam = &team2;
-	}
-	else if (team2_power > team1_power){
-		std::cout << "Team 1 lost" << std::endl;
-		losingTeam = &team1;
-	}
-	else{
-		std::cout << "It's a tie ! Both teams survive." << std::endl;
-		losingTeam = nullptr;
-	}// If both teams have equal power, no players are eliminated.
-
-	if (losingTeam != nullptr){
-		auto player = players.begin();
-		while(player != players.end()){
-
-			auto condi = std::find(losingTeam->begin(), losingTeam->end(), *player);
-
-			if (condi != losingTeam->end()){
-				(*player) -> dyingMessage();
-				delete (*player);
-				player = players.erase(player);
-			
-			}else{
-				++player;
+			if (arranged)
+			{
+				sweepEliminated();
+				left = players.size();
+			}
+			else
+			{
+				first += (1 - losingTeam) * stride;
+				stride *= 2;
+				left = (players.size() - first + stride - 1) / stride;
 			}
-
 		}
+
+		TextOut::standard() << "Team 1 power: " << teams.power[0] << '\n';
+		TextOut::standard() << "Team 2 power: " << teams.power[1] << '\n';
+
+		if (losingTeam < 0)
+			break;
 	}
 
+	sweepEliminated();
 	survivor_count = players.size();
 	death_count = initial_count - survivor_count;
 
-	std::cout << "Team 1 power: " << team1_power << std::endl;
-	std::cout << "Team 2 power: " << team2_power << std::endl;
-
 	printAlivePlayers();
 
-	std::cout << "\n[Game Statistics]" << std::endl;
-	std::cout << "Total players: " << initial_count << std::endl;
-	std::cout << "Survivors: " << survivor_count << std::endl;
-	std::cout << "Deaths: " << death_count << std::endl << std::endl;
+	TextOut::standard() << "\n[Game Statistics]" << '\n';
+	TextOut::standard() << "Total players: " << initial_count << '\n';
+	TextOut::standard() << "Survivors: " << survivor_count << '\n';
+	TextOut::standard() << "Deaths: " << death_count << '\n' << '\n';
 }
 
 
 // Executes Glass Bridge game
 // Each step has one safe glass panel chosen randomly.
 // Players are eliminated when stepping on unsafe glass.
+std::string GlassBridge::getParameters() const
+{
+	return "totalSteps=" + std::to_string(totalSteps);
+}
+
 void GlassBridge::join(Player *player){
 	players.push_back(new PlayerGlassBridge(*player));
 
@@ -263,10 +455,10 @@ void GlassBridge::play(){
 	printGameName();
     initial_count = players.size();
 
-	std::cout << initial_count << " players joined the game." << std::endl;
+	TextOut::standard() << initial_count << " players joined the game." << '\n';
 
 	if (players.size() < 1) {
-		std::cout << "There are not sufficient players." << std::endl;
+		TextOut::standard() << "There are not sufficient players." << '\n';
 		return;
 	}
 
@@ -277,141 +469,148 @@ void GlassBridge::play(){
 	}
 
 	int currentStep = 0;
-	auto player = players.begin();
+	size_t player = 0;
 
 	// The bridge has a single safe path that is shared by all players.
 	// Once a player falls, the safe path up to that point is revealed.
 	// Next players continue from the same step,
 	// making the game easier as more players attempt it.
-	while (player != players.end() && currentStep < totalSteps) {
+	while (player < players.size() && currentStep < totalSteps) {
 		bool chooseCorrect = (Player::getRandomProbability() < 0.5f) == safeGlass[currentStep];
 
 		if (chooseCorrect) {
-			std::cout << "Player #" << (*player)->getAgility() << " stepped on safe glass at step " << (currentStep + 1) << std::endl;
+			TextOut::standard() << "Player #" << players[player]->getAgility() << " stepped on safe glass at step " << (currentStep + 1) << '\n';
 			currentStep++;
 
 			if (currentStep >= totalSteps) {
-				std::cout << "Bridge completed! Remaining players survive." << std::endl;
+				TextOut::standard() << "Bridge completed! Remaining players survive." << '\n';
 				break;
 			}
 		} else {
-			std::cout << "Player #" << (*player)->getAgility() << " fell at step " << (currentStep + 1) << "!" << std::endl;
-			(*player)->dyingMessage();
-			delete (*player);
-			player = players.erase(player);
-
+			TextOut::standard() << "Player #" << players[player]->getAgility() << " fell at step " << (currentStep + 1) << "!" << '\n';
+			eliminate(player);
+			player++;
 		}
 	}
+	sweepEliminated();
 
 	survivor_count = players.size();
 	death_count = initial_count - survivor_count;
+	step_count = currentStep;
 
 	printAlivePlayers();
 
-	std::cout << "\n[Game Statistics]" << std::endl;
-	std::cout << "Total players: " << initial_count << std::endl;
-	std::cout << "Survivors: " << survivor_count << std::endl;
-	std::cout << "Deaths: " << death_count << std::endl;
-	std::cout << "Steps completed: " << currentStep << "/" << totalSteps << std::endl << std::endl;
+	TextOut::standard() << "\n[Game Statistics]" << '\n';
+	TextOut::standard() << "Total players: " << initial_count << '\n';
+	TextOut::standard() << "Survivors: " << survivor_count << '\n';
+	TextOut::standard() << "Deaths: " << death_count << '\n';
+	TextOut::standard() << "Steps completed: " << currentStep << "/" << totalSteps << '\n' << '\n';
 }
 
 
 // Executes Marbles game
 // Players are paired and play odd/even guessing.
 // Winners advance to next round.
+static std::string bracketParameters(const BracketOptions& options)
+{
+	return "seeding=" + std::to_string(int(options.seeding)) + " maxRounds=" + std::to_string(options.maxRounds)
+		+ " target=" + std::to_string(options.target);
+}
+
+std::string Marbles::getParameters() const
+{
+	return bracketParameters(bracket.getOptions());
+}
+
 void Marbles::join(Player *player){
 	players.push_back(new PlayerMarble(*player));
 
 }
 
 
-// If the number of players is odd, one player gets a bye
+// Rounds follow the bracket options; by default one round where,
+// if the number of players is odd, the last player gets a bye
 void Marbles::play(){
 
 	printGameName();
 
     initial_count = players.size();
 
-	std::cout << initial_count << " players joined the game." << std::endl;
+	TextOut::standard() << initial_count << " players joined the game." << '\n';
 
 	if (players.size() < 2) {
-		std::cout << "There are not sufficient players." << std::endl;
+		TextOut::standard() << "There are not sufficient players." << '\n';
 		return;
 	}
 
-	std::list<Player*> winners;
-	std::list<Player*> losers;
-
-	
-	if (players.size() % 2 == 1) {
-		auto lastPlayer = players.end();
-		--lastPlayer;
-		std::cout << "Player #" << (*lastPlayer)->getNumber() << " gets a bye." << std::endl;
-		winners.push_back(*lastPlayer);
-		players.erase(lastPlayer);
-	}
+	bracket.reset();
+	while (bracket.hasNextRound(players.size())) {
 
-	// Players compete in pairs.
-	// Each match produces exactly one winner and one loser.
+		// Matches are pairs (2i, 2i+1); byes come after them
+		size_t numMatches = bracket.seedRound(players, Player::getRandomBuffer());
+		size_t byes = bracket.getByes();
 
-	// Winners advance to the next round.
-	// Losers are eliminated immediately after the round.
+		if (bracket.getOptions().maxRounds > 1)
+			TextOut::standard() << "\n[Round " << bracket.getRound() << "]" << '\n';
 
-	// This structure guarantees that approximately half the players survive each round.
+		for (size_t b = 0; b < byes; ++b) {
+			TextOut::standard() << "Player #" << players[2 * numMatches + b]->getNumber() << " gets a bye." << '\n';
+		}
 
-	int numMatches = players.size() / 2;
+		// Players compete in pairs.
+		// Each match produces exactly one winner and one loser.
 
-	for (int i = 0; i < numMatches; ++i) {
-		auto player1 = players.begin();
-		auto player2 = players.begin();
-		++player2;
+		// Winners advance to the next round.
+		// Losers are eliminated immediately after the round.
 
-		int marbles2 = static_cast<int>(Player::getRandomProbability() * 10) + 1;
+		// This structure guarantees that approximately half the players survive each round.
 
-		bool isOdd = (marbles2 % 2 == 1);
-		bool guessOdd = (Player::getRandomProbability() < 0.5f);
+		// Bit i of batchResults is set when the first player of match i wins
+		batchResults.assign((numMatches + 63) / 64, 0);
 
-		std::cout << "Match: Player #" << (*player1)->getNumber()
-		          << " vs Player #" << (*player2)->getNumber() << std::endl;
+		for (size_t i = 0; i < numMatches; ++i) {
+			Player* player1 = players[2 * i];
+			Player* player2 = players[2 * i + 1];
 
-		Player* winner;
-		Player* loser;
-		if (guessOdd == isOdd) {
-			winner = *player1;
-			loser = *player2;
-		} else {
-			winner = *player2;
-			loser = *player1;
-		}
+			int marbles2 = static_cast<int>(Player::getRandomProbability() * 10) + 1;
 
-		winners.push_back(winner);
-		losers.push_back(loser);
+			bool isOdd = (marbles2 % 2 == 1);
+			bool guessOdd = (Player::getRandomProbability() < 0.5f);
 
-		players.erase(player1);
-		players.erase(player2);
-	}
+			TextOut::standard() << "Match: Player #" << player1->getNumber()
+			          << " vs Player #" << player2->getNumber() << '\n';
 
-	for (auto loser : losers) {
-		loser->dyingMessage();
-		delete loser;
-	}
+			if (guessOdd == isOdd)
+				batchResults[i / 64] |= uint64_t(1) << (i % 64);
+		}
 
+		// Losers are eliminated after the round, in match order
+		for (size_t i = 0; i < numMatches; ++i)
+			eliminate(actResult(batchResults, i) ? 2 * i + 1 : 2 * i);
+		sweepEliminated();
 
-	players = winners;
+		// Byes go to the front, ahead of the match winners
+		std::rotate(players.begin(), players.end() - byes, players.end());
+	}
 
 	survivor_count = players.size();
 	death_count = initial_count - survivor_count;
 
 	printAlivePlayers();
 
-	std::cout << "\n[Game Statistics]" << std::endl;
-	std::cout << "Total players: " << initial_count << std::endl;
-	std::cout << "Survivors: " << survivor_count << std::endl;
-	std::cout << "Deaths: " << death_count << std::endl << std::endl;
+	TextOut::standard() << "\n[Game Statistics]" << '\n';
+	TextOut::standard() << "Total players: " << initial_count << '\n';
+	TextOut::standard() << "Survivors: " << survivor_count << '\n';
+	TextOut::standard() << "Deaths: " << death_count << '\n' << '\n';
 }
 
 
 
+std::string Ddakji::getParameters() const
+{
+	return bracketParameters(bracket.getOptions());
+}
+
 void Ddakji::join(Player *player){
 	players.push_back(new PlayerDdakji(*player));
 
@@ -421,89 +620,77 @@ void Ddakji::join(Player *player){
 // Executes Ddakji game
 // Players compete based on power (agility + fearlessness).
 // In case of tie, the winner is chosen randomly.
+// Rounds and pairing follow the bracket options, as in Marbles.
 void Ddakji::play(){
 
 	printGameName();
 
     initial_count = players.size();
 
-	std::cout << initial_count << " players joined the game." << std::endl;
+	TextOut::standard() << initial_count << " players joined the game." << '\n';
 
 	if (players.size() < 2) {
-		std::cout << "There are not sufficient players." << std::endl;
+		TextOut::standard() << "There are not sufficient players." << '\n';
 		return;
 	}
 
-	std::list<Player*> winners;
-	std::list<Player*> losers;
+	bracket.reset();
+	while (bracket.hasNextRound(players.size())) {
 
-	if (players.size() % 2 == 1) {
-		auto lastPlayer = players.end();
-		--lastPlayer;
-		std::cout << "Player #" << (*lastPlayer)->getNumber() << " gets a bye." << std::endl;
-		winners.push_back(*lastPlayer);
-		players.erase(lastPlayer);
-	}
+		size_t numMatches = bracket.seedRound(players, Player::getRandomBuffer());
+		size_t byes = bracket.getByes();
 
-	int numMatches = players.size() / 2;
+		if (bracket.getOptions().maxRounds > 1)
+			TextOut::standard() << "\n[Round " << bracket.getRound() << "]" << '\n';
 
-	// The winner is primarily determined by player power.
-	// Randomness is applied only when both players have equal power.
+		for (size_t b = 0; b < byes; ++b) {
+			TextOut::standard() << "Player #" << players[2 * numMatches + b]->getNumber() << " gets a bye." << '\n';
+		}
 
-	for (int i = 0; i < numMatches; ++i) {
-		auto player1 = players.begin();
-		auto player2 = players.begin();
-		++player2;
+		// Bit i of batchResults is set when the first player of match i wins
+		batchResults.assign((numMatches + 63) / 64, 0);
 
-		int power1 = (*player1)->getPower();
-		int power2 = (*player2)->getPower();
+		// The winner is primarily determined by player power.
+		// Randomness is applied only when both players have equal power.
 
-		std::cout << "Match: Player #" << (*player1)->getNumber()
-		          << " vs Player #" << (*player2)->getNumber() << std::endl;
+		for (size_t i = 0; i < numMatches; ++i) {
+			Player* player1 = players[2 * i];
+			Player* player2 = players[2 * i + 1];
 
-		Player* winner;
-		Player* loser;
+			int power1 = player1->getPower();
+			int power2 = player2->getPower();
 
-		if (power1 > power2) {
-			winner = *player1;
-			loser = *player2;
-		} else if (power2 > power1) {
-			winner = *player2;
-			loser = *player1;
-		} else {
-			if (Player::getRandomProbability() < 0.5f) {
-				winner = *player1;
-				loser = *player2;
-			} else {
-				winner = *player2;
-				loser = *player1;
-			}
-		}
+			TextOut::standard() << "Match: Player #" << player1->getNumber()
+			          << " vs Player #" << player2->getNumber() << '\n';
 
-		winners.push_back(winner);
-		losers.push_back(loser);
+			bool firstWins;
+			if (power1 != power2)
+				firstWins = (power1 > power2);
+			else
+				firstWins = (Player::getRandomProbability() < 0.5f);
 
-		players.erase(player1);
-		players.erase(player2);
-	}
+			if (firstWins)
+				batchResults[i / 64] |= uint64_t(1) << (i % 64);
+		}
 
-	
-	for (auto loser : losers) {
-		loser->dyingMessage();
-		delete loser;
-	}
+		// Losers are eliminated after the round, in match order
+		for (size_t i = 0; i < numMatches; ++i)
+			eliminate(actResult(batchResults, i) ? 2 * i + 1 : 2 * i);
+		sweepEliminated();
 
-	players = winners;
+		// Byes go to the front, ahead of the match winners
+		std::rotate(players.begin(), players.end() - byes, players.end());
+	}
 
 	survivor_count = players.size();
 	death_count = initial_count - survivor_count;
 
 	printAlivePlayers();
 
-	std::cout << "\n[Game Statistics]" << std::endl;
-	std::cout << "Total players: " << initial_count << std::endl;
-	std::cout << "Survivors: " << survivor_count << std::endl;
-	std::cout << "Deaths: " << death_count << std::endl << std::endl;
+	TextOut::standard() << "\n[Game Statistics]" << '\n';
+	TextOut::standard() << "Total players: " << initial_count << '\n';
+	TextOut::standard() << "Survivors: " << survivor_count << '\n';
+	TextOut::standard() << "Deaths: " << death_count << '\n' << '\n';
 
 }
 
@@ -521,7 +708,7 @@ void Pysical_Asia_ship::play() {
     printGameName();
 
     initial_count = players.size();
-    std::cout << initial_count << " players joined the game." << std::endl;
+    TextOut::standard() << initial_count << " players joined the game." << '\n';
 
     if (players.size() < 3) {
         survivor_count = players.size();
@@ -535,10 +722,11 @@ void Pysical_Asia_ship::play() {
 	// that the final Squid Game can always be played.
     while (players.size() > 2) {
 
-        std::cout << "\n[Task Round " << round << "]" << std::endl;
+        TextOut::standard() << "\n[Task Round " << round << "]" << '\n';
 
         // (player, taskTime)
-        std::vector<std::pair<Player*, float>> results;
+        std::vector<std::pair<Player*, float>>& results = rankedPlayers;
+        results.clear();
 
 	// Each player performs a solo task and produces a completion time.
 	// This simulates a time-based physical challenge.
@@ -559,27 +747,23 @@ void Pysical_Asia_ship::play() {
         int surviveCount = results.size() / 2;  
         if (surviveCount < 2) surviveCount = 2; 
 
-        std::list<Player*> nextPlayers;
+        // Players take their rank order; everyone past surviveCount is eliminated
+        for (size_t i = 0; i < results.size(); ++i)
+            players[i] = results[i].first;
 
-        for (int i = 0; i < results.size(); ++i) {
-            if (i < surviveCount) {
-                nextPlayers.push_back(results[i].first);
-            } else {
-                results[i].first->dyingMessage();
-                delete results[i].first;
-            }
-        }
+        for (size_t i = surviveCount; i < players.size(); ++i)
+            eliminate(i);
+        sweepEliminated();
 
-        players = nextPlayers;
-
-        std::cout << "Survivors: " << players.size() << std::endl;
+        TextOut::standard() << "Survivors: " << players.size() << '\n';
         round++;
     }
 
     survivor_count = players.size();
     death_count = initial_count - survivor_count;
+    round_count = round - 1;
 
-    std::cout << "\n[Final Survivors]" << std::endl;
+    TextOut::standard() << "\n[Final Survivors]" << '\n';
     printAlivePlayers();
 }
 
@@ -591,6 +775,25 @@ void SquidGame::join(Player * player){
 	players.push_back(new PlayerSquidGame (* player));
 }
 
+// Resolves one confrontation per player from two bulk-drawn rolls each.
+// Messages are left to play() so they stay next to each dying message.
+void SquidGame::actAll(Player* const* first, size_t count, std::vector<uint64_t>& results)
+{
+	if (!allExactly<PlayerSquidGame>(first, count))
+		return Game::actAll(first, count, results);
+
+	batchRolls.resize(2 * count);
+	Player::getRandomProbabilities(batchRolls.data(), batchRolls.size());
+
+	results.assign((count + 63) / 64, 0);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (static_cast<PlayerSquidGame*>(first[i])->act(batchRolls[2 * i], batchRolls[2 * i + 1]))
+			results[i / 64] |= uint64_t(1) << (i % 64);
+	}
+}
+
 void SquidGame::play(){
 
 	// This is the final game.
@@ -599,11 +802,11 @@ void SquidGame::play(){
 
     initial_count = players.size();
 
-	std::cout << initial_count << " players joined the game." << std::endl;
+	TextOut::standard() << initial_count << " players joined the game." << '\n';
 
 	// Squid Game requires at least two players to proceed.
 	if (players.size() < 2) {
-		std::cout << "There are not sufficient players." << std::endl;
+		TextOut::standard() << "There are not sufficient players." << '\n';
 		return;
 	}
 
@@ -612,31 +815,29 @@ void SquidGame::play(){
 	// Players who fail their action are immediately eliminated.
 	while(players.size() > 1){
 		
-		std::cout << "\n[FINAL Round]" << std::endl;
-		auto player = players.begin();
+		TextOut::standard() << "\n[FINAL Round]" << '\n';
+		actPlayers();
 
 		// Iterate through all remaining players in the current round
-		while (player != players.end()){
+		for (size_t i = 0; i < players.size(); ++i){
+
+			static_cast<PlayerSquidGame*>(players[i]) -> actionMessage();
 
 			// act() returns true if the player survives this confrontation
-			if ((*player) -> act()){
-				++player;
-			} else{
-				(*player) -> dyingMessage();
-				delete (*player);
-				player = players.erase(player);
-			}	// If act() fails, the player is eliminated and removed immediately
+			if (!actResult(batchResults, i))
+				eliminate(i);	// If act() fails, the player is eliminated
 		}
+		sweepEliminated();
 
 		// After one full round, report the number of survivors
-		std::cout << "Survivors: " << players.size() << std::endl;
+		TextOut::standard() << "Survivors: " << players.size() << '\n';
 
 	}
 	// At this point, either one or zero players remain
 	survivor_count = players.size();
 	death_count = initial_count - survivor_count;
 
-	std:: cout << "\n[Final Survivor]" <<std::endl;
+	TextOut::standard() << "\n[Final Survivor]" <<'\n';
 
 	// If exactly one player remains, that player is recorded as the winner
 	if (survivor_count == 1)
@@ -659,6 +860,8 @@ void Game::printSummary() const
         deathRate = static_cast<float>(death_count) / initial_count * 100.0f;
         survivalRate = static_cast<float>(survivor_count) / initial_count * 100.0f;
     }
+    if (summary_death_rate >= 0.0f)
+        deathRate = summary_death_rate;
 
     std::cout << "| " << gameName
               << " | " << initial_count
@@ -669,9 +872,14 @@ void Game::printSummary() const
 
     if (winner) {
         winner->printStatus();  
+    } else if (compact_winner.getNumber() != 0) {
+        Player(compact_winner.getNumber(), compact_winner.getAgility(), compact_winner.getFearlessness()).printStatus();
     } else {
         std::cout << "N/A";
     }
 
+    // printStatus() writes through TextOut; keep it ahead of the rest of the row
+    TextOut::standard().flush();
+
     std::cout << " |" << std::endl;
 }
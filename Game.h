@@ -1,28 +1,125 @@
 ﻿#include <string>
-#include <list>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "CompactPlayer.h"
+#include "Bracket.h"
+#include "LightModel.h"
+#include "Coroutine.h"
+#include "TeamPower.h"
 
 class Player;
+class RandomBuffer;
+class ImportanceSampler;
+class TaskScheduler;
+struct LaneBlock;
 
 class Game
 {
 protected:
 	std::string gameName;
-	std::list<Player*> players;
+	std::vector<Player*> players;
+	std::vector<Player*> eliminated;	// marked by eliminate(), deleted by sweepEliminated()
 
     unsigned int initial_count = 0;
     unsigned int survivor_count = 0;
     unsigned int death_count = 0;
     Player* winner = nullptr;
+    CompactPlayer compact_winner;	// winner of playCompact(), number 0 if none
+    unsigned int step_count = 0;	// Glass Bridge: steps completed
+    unsigned int round_count = 0;	// Pysical Asia Ship: task rounds played
+    float summary_death_rate = -1.0f;	// exact rate of a merged summary; -1 when the counts give it
+    ImportanceSampler* sampler = nullptr;	// biases playCompact() draws when set
+    TaskScheduler* scheduler = nullptr;	// splits large playCompact() loops into tasks when set
+
+	// Populations at least this large are split into tasks of this many players
+	static const size_t parallelGrain = 1 << 16;
+
+	// Scratch buffers for actAll(), reused across rounds
+	std::vector<Player*> batch;
+	std::vector<uint64_t> batchResults;
+	std::vector<float> batchRolls;
 
 	virtual void printGameName();
+	void actPlayers();
+
+	// Shared elimination: eliminate() prints the dying message and marks the
+	// player during a pass; sweepEliminated() then removes every marked player
+	// in one stable sweep and deletes them together. Indexes stay valid until
+	// the sweep, but an eliminated slot must not be read again.
+	void eliminate(size_t index);
+	size_t sweepEliminated();
 public:
 	Game(std::string name) :gameName(name) {};
-	~Game();
+	virtual ~Game();
 	virtual void join(Player* player) = 0;
 	virtual void play() = 0;
+
+	// Fresh game with the same configuration and no players
+	virtual Game* clone() const = 0;
+
+	// Games cloned on a pinned worker (--numa) live on its node
+	static void* operator new(size_t bytes) { return NodeArena::allocateLocal(bytes); }
+	static void operator delete(void* pointer) { NodeArena::releaseLocal(pointer); }
+
+	// Every setting that changes the game's results, as text (ResultCache key)
+	virtual std::string getParameters() const { return ""; }
+
+	// Runs the game quietly on a compact population.
+	// Survivors stay in population in the order play() would keep them.
+	// The default converts to Player objects and calls play().
+	virtual void playCompact(Population& population, RandomBuffer& rng);
+
+	// Same as playCompact() on a copy of source, without writing to source:
+	// the survivors are left in population. Games that find their first
+	// survivors in a read-only pass override it and copy only those; the
+	// default copies source and plays on the copy.
+	virtual void playCompactFrom(const Population& source, Population& population, RandomBuffer& rng);
+
+#ifdef __cpp_impl_coroutine
+	// Coroutine form of playCompact(), suspending at round boundaries.
+	// Played to the end it leaves the same population, counts and winner
+	// as playCompact() without a scheduler. The default plays the whole
+	// game as one round.
+	virtual GameSteps playSteps(Population& population, RandomBuffer& rng);
+#endif
+
+	// Lane form of playCompact() for many tournaments side by side (Lanes.h):
+	// each player's outcome in every lane follows the same rules, but the
+	// draws are made per slot for all lanes, so lanes do not reproduce any
+	// one-at-a-time run. Only called when hasLanes() is true.
+	virtual bool hasLanes() const { return false; }
+	virtual void playLanes(LaneBlock&, RandomBuffer&) {};
+
+	// Sizes the scratch buffers of playCompact() for populations of up to
+	// playerCount players numbered up to maxNumber, so later plays on such
+	// populations make no heap allocations
+	virtual void reserve(size_t, int) {};
+
+	// Batch form of act(): resolves count players starting at first and sets
+	// bit i of results when the i-th player's act() would return true.
+	// The default falls back to per-player act(); games override it to
+	// draw their randomness for the whole segment at once.
+	virtual void actAll(Player* const* first, size_t count, std::vector<uint64_t>& results);
+	static bool actResult(const std::vector<uint64_t>& results, size_t i) { return (results[i / 64] >> (i % 64)) & 1; };
+
 	void printAlivePlayers();
-	std::list<Player*> getAlivePlayers() { return players; };
+	const std::vector<Player*>& getAlivePlayers() const { return players; };
+	void resetStats();
+	// Merged results shown as rounded counts; deathRate (percent) is taken
+	// from the exact totals when given, so it is not skewed by the rounding
+	void setSummary(unsigned int initial, unsigned int survivors, unsigned int deaths, const CompactPlayer& winner, float deathRate = -1.0f);
+	void setSampler(ImportanceSampler* sampler) { this->sampler = sampler; }
+	void setScheduler(TaskScheduler* scheduler) { this->scheduler = scheduler; }
     void printSummary() const;
+
+	const std::string& getName() const { return gameName; }
+	unsigned int getInitialCount() const { return initial_count; }
+	unsigned int getSurvivorCount() const { return survivor_count; }
+	unsigned int getDeathCount() const { return death_count; }
+	unsigned int getStepCount() const { return step_count; }
+	unsigned int getRoundCount() const { return round_count; }
+	const CompactPlayer& getCompactWinner() const { return compact_winner; }
 };
 
 
@@ -32,14 +129,33 @@ class RedLightGreenLight : public Game
 
 	static const unsigned int distance;
 	static const float fallDownRate;
+	static const uint32_t fallThreshold;	// RandomBuffer::threshold(fallDownRate)
 
 	const unsigned int turn = 20;
+
+	// With light phases enabled, turn is the number of green lights
+	LightModel<std::vector<Player*>> lights;
+	LightModel<Population> compactLights;
+
+	void playLights();
+	void playTurn(CompactPlayer* first, CompactPlayer* last, unsigned int t, RandomBuffer& rng);
 public:
 	RedLightGreenLight() : Game("Red Light Green Light") {};
-	RedLightGreenLight(int t) : Game("Red Light Green Light"), turn(t) {};
+	RedLightGreenLight(int t, const LightOptions& lights = LightOptions())
+		: Game("Red Light Green Light"), turn(t), lights(lights), compactLights(lights) {};
 	~RedLightGreenLight() {};
 	void join(Player* player);
 	void play();
+	Game* clone() const { return new RedLightGreenLight(turn, lights.getOptions()); };
+	std::string getParameters() const;
+	void playCompact(Population& population, RandomBuffer& rng);
+	void reserve(size_t playerCount, int) { compactLights.reserve(playerCount); };
+	bool hasLanes() const { return !compactLights.getOptions().enabled; };
+	void playLanes(LaneBlock& block, RandomBuffer& rng);
+#ifdef __cpp_impl_coroutine
+	GameSteps playSteps(Population& population, RandomBuffer& rng);
+#endif
+	void actAll(Player* const* first, size_t count, std::vector<uint64_t>& results);
 };
 
 
@@ -50,11 +166,19 @@ class RPS : public Game
 {
 	friend class PlayerRPS;
 
+	bool loses(const CompactPlayer& p, RandomBuffer& rng) const;
+
 public:
 	RPS() : Game("Rock Paper Scissors") {};
 	~RPS() {};
 	void join(Player* player);
 	void play();
+	Game* clone() const { return new RPS(); };
+	void playCompact(Population& population, RandomBuffer& rng);
+	void playCompactFrom(const Population& source, Population& population, RandomBuffer& rng);
+	bool hasLanes() const { return true; };
+	void playLanes(LaneBlock& block, RandomBuffer& rng);
+	void actAll(Player* const* first, size_t count, std::vector<uint64_t>& results);
 };
 
 
@@ -62,11 +186,21 @@ class TugOfWar : public Game{
 
 	friend class PlayerTOW;
 
+	RopeOptions options;
+	PowerColumn column;		// Rotate and Swap: candidate splits of the current round
+
+	size_t playRounds(const Population& population, size_t& first);
+
 public:
-	TugOfWar() : Game("Tug of War") {};
+	TugOfWar(const RopeOptions& options = RopeOptions()) : Game("Tug of War"), options(options) {};
 	~TugOfWar() {};
 	void join(Player* player);
 	void play();
+	Game* clone() const { return new TugOfWar(options); };
+	std::string getParameters() const;
+	void reserve(size_t playerCount, int) { if (options.split != RopeOptions::Alternate) column.reserve(playerCount); };
+	void playCompact(Population& population, RandomBuffer& rng);
+	void playCompactFrom(const Population& source, Population& population, RandomBuffer& rng);
 };
 
 
@@ -76,52 +210,113 @@ class GlassBridge : public Game
 
 	friend class PlayerGlassBridge;
 
+	size_t cross(const Population& population, RandomBuffer& rng);
+
 	public :
 		GlassBridge() : Game("Glass Bridge") {};
 		~GlassBridge() {};
 		void join(Player * player);
 		void play();
+		Game* clone() const { return new GlassBridge(); };
+		std::string getParameters() const;
+		void playCompact(Population& population, RandomBuffer& rng);
+		void playCompactFrom(const Population& source, Population& population, RandomBuffer& rng);
 
 };
 
 
 class Marbles : public Game {
 
+	Bracket<std::vector<Player*>> bracket;
+	Bracket<Population> compactBracket;
+
+	void playRound(Population& population, RandomBuffer& rng);
+
 	public : 
-		Marbles() : Game("Marbles") {};
+		Marbles(const BracketOptions& options = BracketOptions()) : Game("Marbles"), bracket(options), compactBracket(options) {};
 		~Marbles() {};
 		void join(Player * player);
 		void play();
+		Game* clone() const { return new Marbles(bracket.getOptions()); };
+		std::string getParameters() const;
+		void playCompact(Population& population, RandomBuffer& rng);
+		void reserve(size_t playerCount, int maxNumber) { compactBracket.reserve(playerCount, maxNumber); };
+#ifdef __cpp_impl_coroutine
+		GameSteps playSteps(Population& population, RandomBuffer& rng);
+#endif
 
 };
 
 
 class Ddakji : public Game {
 
+	Bracket<std::vector<Player*>> bracket;
+	Bracket<Population> compactBracket;
+
+	void playRound(Population& population, RandomBuffer& rng);
+
 	public : 
-		Ddakji() : Game("Ddakji") {} ;
+		Ddakji(const BracketOptions& options = BracketOptions()) : Game("Ddakji"), bracket(options), compactBracket(options) {} ;
 		~Ddakji() {};
 		void join(Player *player);
 		void play();
+		Game* clone() const { return new Ddakji(bracket.getOptions()); };
+		std::string getParameters() const;
+		void playCompact(Population& population, RandomBuffer& rng);
+		void reserve(size_t playerCount, int maxNumber) { compactBracket.reserve(playerCount, maxNumber); };
+#ifdef __cpp_impl_coroutine
+		GameSteps playSteps(Population& population, RandomBuffer& rng);
+#endif
 };
 
 class Pysical_Asia_ship : public Game{
 
+	// Scratch buffers for play() and playCompact(), reused across rounds
+	std::vector<std::pair<Player*, float>> rankedPlayers;
+	std::vector<std::pair<float, uint32_t>, NodeAllocator<std::pair<float, uint32_t>>> taskTimes;
+	Population ranked;
+
+	void playRound(const Population& source, Population& population, RandomBuffer& rng);
+	void playRound(Population& population, RandomBuffer& rng) { playRound(population, population, rng); };
+
 	public : 
 		Pysical_Asia_ship() : Game("Pysical Asia Ship") {};
 		~Pysical_Asia_ship() {};
 
 		void join(Player *player);
 		void play();
+		Game* clone() const { return new Pysical_Asia_ship(); };
+		void playCompact(Population& population, RandomBuffer& rng);
+		void playCompactFrom(const Population& source, Population& population, RandomBuffer& rng);
+		void reserve(size_t playerCount, int maxNumber);
+#ifdef __cpp_impl_coroutine
+		GameSteps playSteps(Population& population, RandomBuffer& rng);
+#endif
 };
 
 
 class SquidGame : public Game{
 
+	// Attack or defend with equal chance
+	static constexpr uint32_t attackThreshold = RandomBuffer::threshold(0.5f);
+
+	bool loses(const CompactPlayer& p, RandomBuffer& rng) const;
+	void playRound(const Population& source, Population& population, RandomBuffer& rng);
+	void playRound(Population& population, RandomBuffer& rng) { playRound(population, population, rng); };
+
 	public : 
 		SquidGame() : Game("SquidGame") {};
 		~SquidGame() {};
 
 		void join(Player *player);
 		void play();
-};
\ No newline at end of file
+		Game* clone() const { return new SquidGame(); };
+		void playCompact(Population& population, RandomBuffer& rng);
+		void playCompactFrom(const Population& source, Population& population, RandomBuffer& rng);
+		bool hasLanes() const { return true; };
+		void playLanes(LaneBlock& block, RandomBuffer& rng);
+#ifdef __cpp_impl_coroutine
+		GameSteps playSteps(Population& population, RandomBuffer& rng);
+#endif
+		void actAll(Player* const* first, size_t count, std::vector<uint64_t>& results);
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include "CompactPlayer.h"
+#include "MonteCarlo.h"
+
+class Game;
+class RandomBuffer;
+class TaskScheduler;
+
+// Biases the random draws that decide one target player's fate and tracks
+// the likelihood ratio of the run, so weight * [target won] is an unbiased
+// estimate of the target's win probability under the normal rules.
+// Games consult it in playCompact() when one is attached with setSampler().
+//
+// A run in which the target dies contributes 0 whatever else happens, so
+// the target's own survival events are forced and the weight takes their
+// probability. Only draws that hurt the target indirectly are merely tilted.
+class ImportanceSampler
+{
+	int target;
+	float strength;		// 0 = no tilt of other players' draws, towards 1 = strongest
+	double weight = 1.0;
+public:
+	ImportanceSampler(int target, float strength) : target(target), strength(strength) {};
+
+	int getTarget() const { return target; }
+	bool isTarget(const CompactPlayer& p) const { return p.getNumber() == target; }
+
+	void reset() { weight = 1.0; }
+	double getWeight() const { return weight; }
+
+	// Target survives an event of probability p; always true
+	bool survive(float p) { weight *= p; return true; }
+
+	// Uniform [0, 1) draw conditioned on being below limit
+	float drawBelow(RandomBuffer& rng, float limit);
+
+	// Event of probability p under the real rules, sampled with probability q
+	bool draw(RandomBuffer& rng, float p, float q);
+
+	// Event that hurts the target, made less likely
+	bool drawAvoiding(RandomBuffer& rng, float p) { return draw(rng, p, p * (1.0f - strength)); }
+};
+
+// Estimates the probability that one player wins the tournament by
+// importance sampling, and compares its variance with plain Monte Carlo
+class RareEventEstimator
+{
+	std::vector<const Game*> games;
+	Population population;
+	uint64_t seed;
+	int target;
+	float strength;
+
+	RunningEstimate estimate;
+	uint64_t wins = 0;
+public:
+	RareEventEstimator(const std::vector<const Game*>& games, const Population& population, uint64_t seed,
+		int target, float strength = 0.3f)
+		: games(games), population(population), seed(seed), target(target), strength(strength) {};
+
+	// Plays runs [0, runs) as jobs on the scheduler (nullptr = TaskScheduler::shared())
+	void run(uint64_t runs, TaskScheduler* scheduler = nullptr);
+
+	double getProbability() const { return estimate.getMean(); }
+	double getHalfWidth(double z = 1.96) const { return estimate.getHalfWidth(z, false); }
+	void printReport() const;
+};
@@ -0,0 +1,208 @@
+#include "Interleaving.h"
+
+#ifdef __cpp_impl_coroutine
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include "Game.h"
+#include "Metrics.h"
+#include "Random.h"
+#include "Scheduler.h"
+
+namespace
+{
+	double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// One tournament in flight
+	struct Slot
+	{
+		std::vector<std::unique_ptr<Game>> games;
+		Population population;
+		size_t game = 0;
+		GameSteps steps;
+		bool active = false;
+	};
+}
+
+InterleavedRunner::InterleavedRunner(const std::vector<const Game*>& games, const Population& population, uint64_t seed)
+	: games(games), population(population), seed(seed)
+{
+	initial.assign(games.size(), 0);
+	survivors.assign(games.size(), 0);
+	deaths.assign(games.size(), 0);
+	wins.resize(games.size());
+}
+
+void InterleavedRunner::run(uint64_t totalRuns, size_t width, TaskScheduler* scheduler, double maxSeconds)
+{
+	if (width == 0)
+		width = 1;
+
+	// Enough runs per batch that every slot plays several tournaments
+	const uint64_t batchRuns = uint64_t(width) * 16;
+	uint64_t batches = (totalRuns + batchRuns - 1) / batchRuns;
+	double deadline = maxSeconds > 0 ? now() + maxSeconds : 0;
+
+	auto playBatches = [&](size_t first, size_t last) {
+		for (size_t b = first; b < last; ++b)
+		{
+			uint64_t begin = b * batchRuns;
+			playBatch(b, std::min(batchRuns, totalRuns - begin), width, deadline);
+		}
+	};
+
+	if (scheduler)
+		scheduler->parallelFor(0, batches, 1, playBatches);
+	else
+		playBatches(0, batches);
+}
+
+void InterleavedRunner::playBatch(uint64_t batch, uint64_t count, size_t width, double deadline)
+{
+	if (deadline > 0 && now() > deadline)
+	{
+		std::lock_guard<std::mutex> hold(mergeLock);
+		cancelled += count;
+		return;
+	}
+
+	RandomBuffer rng(seed + 1 + batch);
+
+	std::vector<uint64_t> batchInitial(games.size(), 0), batchSurvivors(games.size(), 0), batchDeaths(games.size(), 0);
+	std::vector<CompactPlayer> winners;
+	uint64_t finished = 0, dropped = 0;
+
+	std::vector<Slot> slots(std::min<uint64_t>(width, count));
+	uint64_t started = 0;
+
+	auto start = [&](Slot& slot) {
+		slot.population.assign(population.begin(), population.end());
+		slot.game = 0;
+		for (auto& game : slot.games)
+			game->resetStats();
+		slot.steps = slot.games[0]->playSteps(slot.population, rng);
+		slot.active = true;
+		started++;
+	};
+
+	for (auto& slot : slots)
+	{
+		for (auto game : games)
+			slot.games.emplace_back(game->clone());
+		slot.population.reserve(population.size());
+		start(slot);
+	}
+
+	size_t live = slots.size();
+	while (live > 0)
+	{
+		bool late = deadline > 0 && now() > deadline;
+
+		for (auto& slot : slots)
+		{
+			if (!slot.active)
+				continue;
+
+			if (late)
+			{
+				slot.steps = GameSteps();
+				slot.active = false;
+				dropped++;
+				live--;
+				continue;
+			}
+
+			if (slot.steps.resume())
+				continue;
+
+			// This game is over; go on to the next one or finish the tournament
+			if (++slot.game < slot.games.size())
+			{
+				slot.steps = slot.games[slot.game]->playSteps(slot.population, rng);
+				continue;
+			}
+
+			for (size_t g = 0; g < slot.games.size(); ++g)
+			{
+				const Game& game = *slot.games[g];
+				batchInitial[g] += game.getInitialCount();
+				batchSurvivors[g] += game.getSurvivorCount();
+				batchDeaths[g] += game.getDeathCount();
+				winners.push_back(game.getCompactWinner());
+			}
+			finished++;
+
+			if (Metrics::isEnabled())
+			{
+				Metrics::Block& block = Metrics::local();
+				for (size_t g = 0; g < slot.games.size(); ++g)
+					block.addGame(g, slot.games[g]->getInitialCount(), slot.games[g]->getSurvivorCount());
+				block.addRun();
+			}
+
+			if (started < count)
+				start(slot);
+			else
+			{
+				slot.steps = GameSteps();
+				slot.active = false;
+				live--;
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> hold(mergeLock);
+	for (size_t g = 0; g < games.size(); ++g)
+	{
+		initial[g] += batchInitial[g];
+		survivors[g] += batchSurvivors[g];
+		deaths[g] += batchDeaths[g];
+	}
+	for (size_t i = 0; i < winners.size(); ++i)
+	{
+		const CompactPlayer& winner = winners[i];
+		if (winner.getNumber() == 0)
+			continue;
+		auto& entry = wins[i % games.size()][winner.getNumber()];
+		entry.first++;
+		entry.second = winner;
+	}
+	runs += finished;
+	cancelled += dropped + (count - started);
+}
+
+void InterleavedRunner::applyTo(const std::vector<Game*>& games) const
+{
+	for (size_t g = 0; g < games.size() && g < this->games.size(); ++g)
+	{
+		CompactPlayer best;
+		uint64_t bestWins = 0;
+		for (auto& entry : wins[g])
+		{
+			if (entry.second.first > bestWins)
+			{
+				bestWins = entry.second.first;
+				best = entry.second.second;
+			}
+		}
+
+		double scale = runs > 0 ? 1.0 / runs : 0.0;
+		games[g]->setSummary(unsigned(std::llround(initial[g] * scale)),
+			unsigned(std::llround(survivors[g] * scale)),
+			unsigned(std::llround(deaths[g] * scale)), best,
+			initial[g] > 0 ? float(100.0 * deaths[g] / initial[g]) : 0.0f);
+	}
+}
+
+void InterleavedRunner::printReport() const
+{
+	std::cout << "\n================ Interleaved Runs ================\n";
+	std::cout << "Runs finished: " << runs << std::endl;
+	std::cout << "Runs cancelled: " << cancelled << std::endl;
+	std::cout << "Totals are means per run; Notes shows the most frequent winner." << std::endl;
+}
+#endif
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "CompactPlayer.h"
+#include "Coroutine.h"
+
+class Game;
+class TaskScheduler;
+
+#ifdef __cpp_impl_coroutine
+// Plays many small compact tournaments side by side, a round at a time.
+// Runs are split into batches; a batch owns width slots, each with its own
+// games and population and the coroutine of the game it is in. The batch
+// resumes its slots in turn, one round each, and a slot that finishes its
+// tournament starts the next one. The slots of a batch draw from one
+// random buffer, seeded by the batch index, so results do not depend on
+// the number of threads. Once the time limit passes, every tournament in
+// flight is cancelled at its next round boundary by destroying its
+// coroutine, and only finished tournaments are counted.
+class InterleavedRunner
+{
+	std::vector<const Game*> games;
+	Population population;
+	uint64_t seed;
+
+	// Merged over every finished tournament
+	std::mutex mergeLock;
+	uint64_t runs = 0;
+	uint64_t cancelled = 0;
+	std::vector<uint64_t> initial, survivors, deaths;
+	std::vector<std::map<uint32_t, std::pair<uint64_t, CompactPlayer>>> wins;	// per game: number -> (wins, player)
+
+	void playBatch(uint64_t batch, uint64_t count, size_t width, double deadline);
+public:
+	InterleavedRunner(const std::vector<const Game*>& games, const Population& population, uint64_t seed);
+
+	// Plays totalRuns tournaments, width at a time per batch, with the
+	// batches spread over the scheduler. maxSeconds of 0 means no limit.
+	void run(uint64_t totalRuns, size_t width, TaskScheduler* scheduler, double maxSeconds = 0);
+
+	// Stores the per-run means and the most frequent winner of each game
+	// in games, so their printSummary() shows the merged result
+	void applyTo(const std::vector<Game*>& games) const;
+	void printReport() const;
+
+	uint64_t getRunCount() const { return runs; }
+	uint64_t getCancelledCount() const { return cancelled; }
+};
+#endif
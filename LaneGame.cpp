@@ -0,0 +1,82 @@
+#include "Game.h"
+#include "Player.h"
+#include "Lanes.h"
+
+// Lane versions of the games.
+// Each playLanes() applies the rules of playCompact() to every lane of a
+// LaneBlock at once: a slot's outcome in all lanes comes from one mask of
+// per-lane draws, and lanes a game would skip (too few players) are left
+// untouched. Draws that cannot change an outcome are not made.
+
+
+// A player moves the same distance every turn, so whether they cross the
+// line in time is known up front, and a player who crosses survives
+// whether or not they fell first. Only the slow ones draw their fall
+// rolls, one lane mask per turn, and die in the lanes where they never fell.
+void RedLightGreenLight::playLanes(LaneBlock& block, RandomBuffer& rng)
+{
+	for (size_t s = 0; s < block.slots; ++s)
+	{
+		uint64_t playing = block.alive[s];
+		if (playing == 0)
+			continue;
+
+		const CompactPlayer& p = block.players[s];
+		uint64_t speed = PlayerRLGL::movingDistance(p.getNumber(), p.getAgility(), p.getFearlessness());
+		if (speed * turn >= distance)
+			continue;
+
+		for (unsigned int t = 0; t < turn && playing != 0; ++t)
+			playing &= ~LaneBlock::chances(rng, fallThreshold);
+		block.remove(s, playing);
+	}
+}
+
+
+// A non-tie match is a fair coin, so one random bit per lane decides it
+void RPS::playLanes(LaneBlock& block, RandomBuffer& rng)
+{
+	uint64_t lanes = block.lanesWith(2);
+	for (size_t s = 0; s < block.slots; ++s)
+	{
+		if (block.alive[s] & lanes)
+			block.remove(s, LaneBlock::coins(rng) & lanes);
+	}
+}
+
+
+// Rounds go on in each lane until at most one player is left there;
+// a lane that ends with one crowns them
+void SquidGame::playLanes(LaneBlock& block, RandomBuffer& rng)
+{
+	uint64_t started = block.lanesWith(2);
+	uint64_t lanes = started;
+	while (lanes != 0)
+	{
+		for (size_t s = 0; s < block.slots; ++s)
+		{
+			uint64_t here = block.alive[s] & lanes;
+			if (here == 0)
+				continue;
+
+			const CompactPlayer& p = block.players[s];
+			uint64_t attack = LaneBlock::coins(rng);
+			uint64_t success = LaneBlock::chances(rng, attack,
+				PlayerSquidGame::successThreshold(p.getAgility(), p.getFearlessness(), true),
+				PlayerSquidGame::successThreshold(p.getAgility(), p.getFearlessness(), false));
+			block.remove(s, here & ~success);
+		}
+		lanes &= block.lanesWith(2);
+	}
+
+	uint64_t crowned = started & block.lanesWith(1);
+	for (size_t s = 0; s < block.slots && crowned != 0; ++s)
+	{
+		uint64_t bits = block.alive[s] & crowned;
+		for (size_t l = 0; bits != 0; ++l, bits >>= 1)
+		{
+			if (bits & 1)
+				block.winners[l] = block.players[s];
+		}
+	}
+}
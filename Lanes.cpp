@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "Lanes.h"
+#include "Game.h"
+#include "Metrics.h"
+#include "Scheduler.h"
+
+namespace
+{
+	double now()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+LaneTournaments::LaneTournaments(const std::vector<const Game*>& prototypes, const Population& start)
+	: start(start), rng(0)
+{
+	int maxNumber = 0;
+	for (auto& player : start)
+		maxNumber = std::max(maxNumber, player.getNumber());
+
+	for (auto prototype : prototypes)
+	{
+		games.emplace_back(prototype->clone());
+		games.back()->reserve(start.size(), maxNumber);
+	}
+
+	slotOf.assign(size_t(maxNumber) + 1, 0);
+	for (size_t s = 0; s < start.size(); ++s)
+		slotOf[start[s].getNumber()] = uint32_t(s);
+
+	records.assign(LaneBlock::width, std::vector<GameRecord>(games.size()));
+	lanes.resize(LaneBlock::width);
+	for (auto& lane : lanes)
+		lane.reserve(start.size());
+	alive.reserve(start.size());
+}
+
+LaneTournaments::~LaneTournaments()
+{
+}
+
+void LaneTournaments::run(uint64_t seed, size_t laneCount)
+{
+	laneCount = std::min(laneCount, LaneBlock::width);
+	rng.reseed(seed);
+
+	uint64_t used = laneCount == LaneBlock::width ? ~uint64_t(0) : (uint64_t(1) << laneCount) - 1;
+	alive.assign(start.size(), used);
+	listed = false;
+
+	for (size_t g = 0; g < games.size(); ++g)
+	{
+		if (games[g]->hasLanes())
+			playLanes(*games[g], g, laneCount);
+		else
+			playEach(*games[g], g, laneCount);
+	}
+}
+
+// Every lane at once on the shared slots
+void LaneTournaments::playLanes(Game& game, size_t g, size_t laneCount)
+{
+	LaneBlock block;
+	block.players = start.data();
+	block.alive = alive.data();
+	block.slots = start.size();
+
+	if (listed)
+	{
+		std::fill(alive.begin(), alive.end(), 0);
+		for (size_t l = 0; l < laneCount; ++l)
+		{
+			for (auto& player : lanes[l])
+				alive[slotOf[player.getNumber()]] |= uint64_t(1) << l;
+			block.counts[l] = uint32_t(lanes[l].size());
+		}
+	}
+	else if (g == 0)
+	{
+		for (size_t l = 0; l < laneCount; ++l)
+			block.counts[l] = uint32_t(start.size());
+	}
+	else
+	{
+		for (size_t l = 0; l < laneCount; ++l)
+			block.counts[l] = records[l][g - 1].survivor_count;
+	}
+
+	uint32_t before[LaneBlock::width];
+	std::copy(block.counts, block.counts + LaneBlock::width, before);
+
+	game.playLanes(block, rng);
+
+	for (size_t l = 0; l < laneCount; ++l)
+	{
+		GameRecord& record = records[l][g];
+		record = GameRecord();
+		record.initial_count = before[l];
+		record.survivor_count = block.counts[l];
+		record.death_count = record.initial_count - record.survivor_count;
+		record.winner = block.winners[l];
+	}
+
+	// Each lane keeps its own order; only the dead leave it
+	if (listed)
+	{
+		for (size_t l = 0; l < laneCount; ++l)
+		{
+			lanes[l].erase(std::remove_if(lanes[l].begin(), lanes[l].end(),
+				[&](const CompactPlayer& p) { return ((alive[slotOf[p.getNumber()]] >> l) & 1) == 0; }), lanes[l].end());
+		}
+	}
+}
+
+// Lane by lane with playCompact(), after moving the lanes out of the masks
+void LaneTournaments::playEach(Game& game, size_t g, size_t laneCount)
+{
+	if (!listed)
+	{
+		for (size_t l = 0; l < laneCount; ++l)
+			lanes[l].clear();
+		for (size_t s = 0; s < start.size(); ++s)
+		{
+			uint64_t bits = alive[s];
+			for (size_t l = 0; bits != 0; ++l, bits >>= 1)
+			{
+				if (bits & 1)
+					lanes[l].push_back(start[s]);
+			}
+		}
+		listed = true;
+	}
+
+	for (size_t l = 0; l < laneCount; ++l)
+	{
+		game.resetStats();
+		game.playCompact(lanes[l], rng);
+		records[l][g] = makeRecord(game);
+	}
+}
+
+
+LaneRunner::LaneRunner(const std::vector<const Game*>& games, const Population& population, uint64_t seed)
+	: games(games), population(population), seed(seed)
+{
+	initial.assign(games.size(), 0);
+	survivors.assign(games.size(), 0);
+	deaths.assign(games.size(), 0);
+	wins.resize(games.size());
+}
+
+void LaneRunner::run(uint64_t totalRuns, TaskScheduler* scheduler, double maxSeconds)
+{
+	const uint64_t blockRuns = LaneBlock::width;
+	uint64_t blocks = (totalRuns + blockRuns - 1) / blockRuns;
+	double deadline = maxSeconds > 0 ? now() + maxSeconds : 0;
+
+	size_t slots = scheduler ? scheduler->getConcurrency() : 1;
+	std::vector<std::unique_ptr<LaneTournaments>> engines(slots);
+
+	auto playBlocks = [&](size_t first, size_t last) {
+		size_t slot = scheduler ? scheduler->currentSlot() : 0;
+		if (!engines[slot])
+			engines[slot].reset(new LaneTournaments(games, population));
+		LaneTournaments& engine = *engines[slot];
+
+		for (size_t b = first; b < last; ++b)
+		{
+			uint64_t count = std::min(blockRuns, totalRuns - b * blockRuns);
+			if (deadline > 0 && now() > deadline)
+			{
+				std::lock_guard<std::mutex> hold(mergeLock);
+				cancelled += count;
+				continue;
+			}
+
+			engine.run(seed + 1 + b, size_t(count));
+
+			Metrics::Block* metrics = Metrics::isEnabled() ? &Metrics::local() : nullptr;
+			std::lock_guard<std::mutex> hold(mergeLock);
+			for (size_t l = 0; l < count; ++l)
+			{
+				const std::vector<GameRecord>& records = engine.getRecords(l);
+				for (size_t g = 0; g < records.size(); ++g)
+				{
+					initial[g] += records[g].initial_count;
+					survivors[g] += records[g].survivor_count;
+					deaths[g] += records[g].death_count;
+					if (metrics)
+						metrics->addGame(g, records[g].initial_count, records[g].survivor_count);
+
+					const CompactPlayer& winner = records[g].winner;
+					if (winner.getNumber() == 0)
+						continue;
+					auto& entry = wins[g][winner.getNumber()];
+					entry.first++;
+					entry.second = winner;
+				}
+				if (metrics)
+					metrics->addRun();
+			}
+			runs += count;
+		}
+	};
+
+	if (scheduler)
+		scheduler->parallelFor(0, blocks, 1, playBlocks);
+	else
+		playBlocks(0, blocks);
+}
+
+void LaneRunner::applyTo(const std::vector<Game*>& games) const
+{
+	for (size_t g = 0; g < games.size() && g < this->games.size(); ++g)
+	{
+		CompactPlayer best;
+		uint64_t bestWins = 0;
+		for (auto& entry : wins[g])
+		{
+			if (entry.second.first > bestWins)
+			{
+				bestWins = entry.second.first;
+				best = entry.second.second;
+			}
+		}
+
+		double scale = runs > 0 ? 1.0 / runs : 0.0;
+		games[g]->setSummary(unsigned(std::llround(initial[g] * scale)),
+			unsigned(std::llround(survivors[g] * scale)),
+			unsigned(std::llround(deaths[g] * scale)), best,
+			initial[g] > 0 ? float(100.0 * deaths[g] / initial[g]) : 0.0f);
+	}
+}
+
+void LaneRunner::printReport() const
+{
+	std::cout << "\n================ Lane Runs ================\n";
+	std::cout << "Runs finished: " << runs << std::endl;
+	std::cout << "Runs cancelled: " << cancelled << std::endl;
+	std::cout << "Totals are means per run; Notes shows the most frequent winner." << std::endl;
+}
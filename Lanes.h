@@ -0,0 +1,133 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "CompactPlayer.h"
+#include "Random.h"
+#include "Tournament.h"
+
+class Game;
+class TaskScheduler;
+
+// Up to 64 tournaments of one starting population side by side.
+// Slot s is the same player in every tournament, and bit l of alive[s]
+// says whether tournament (lane) l still has them, so a game advances
+// every lane at once with mask operations and draws one word per lane
+// for a whole slot.
+struct LaneBlock
+{
+	static constexpr size_t width = 64;
+
+	const CompactPlayer* players = nullptr;	// by slot
+	uint64_t* alive = nullptr;				// by slot
+	size_t slots = 0;
+	uint32_t counts[width] = {};			// players left per lane
+	CompactPlayer winners[width];			// set by games that crown one
+
+	// Lanes holding at least min players
+	uint64_t lanesWith(uint32_t min) const
+	{
+		uint64_t lanes = 0;
+		for (size_t l = 0; l < width; ++l)
+			lanes |= uint64_t(counts[l] >= min) << l;
+		return lanes;
+	}
+
+	// Takes the player in slot out of the dead lanes
+	void remove(size_t slot, uint64_t dead)
+	{
+		dead &= alive[slot];
+		alive[slot] &= ~dead;
+		for (size_t l = 0; dead != 0; ++l, dead >>= 1)
+			counts[l] -= uint32_t(dead & 1);
+	}
+
+	// One Bernoulli draw per lane: bit l is set with nextProbability() < p
+	// for the threshold of p
+	static uint64_t chances(RandomBuffer& rng, uint32_t threshold)
+	{
+		uint32_t words[width];
+		rng.fillWords(words, width);
+		uint64_t bits = 0;
+		for (size_t l = 0; l < width; ++l)
+			bits |= uint64_t((words[l] >> 8) < threshold) << l;
+		return bits;
+	}
+
+	// As above, with the threshold of lane l chosen by bit l of select
+	static uint64_t chances(RandomBuffer& rng, uint64_t select, uint32_t whenSet, uint32_t whenClear)
+	{
+		uint32_t words[width];
+		rng.fillWords(words, width);
+		uint64_t bits = 0;
+		for (size_t l = 0; l < width; ++l)
+			bits |= uint64_t((words[l] >> 8) < ((select >> l) & 1 ? whenSet : whenClear)) << l;
+		return bits;
+	}
+
+	// One fair coin per lane
+	static uint64_t coins(RandomBuffer& rng) { return (uint64_t(rng.nextWord()) << 32) | rng.nextWord(); }
+};
+
+// Plays one block of tournaments on one thread.
+// Games with a lane version (Game::hasLanes()) advance every lane at once
+// on the shared slots. The others are played lane by lane with
+// playCompact() on each lane's own population, kept in the order the
+// game leaves it; a lane game after them works on the union of the lanes
+// and each lane's survivors keep their order.
+class LaneTournaments
+{
+	std::vector<std::unique_ptr<Game>> games;
+	std::vector<std::vector<GameRecord>> records;	// lane -> game
+	Population start;
+	std::vector<uint32_t> slotOf;		// number -> slot in start
+	std::vector<uint64_t> alive;
+	std::vector<Population> lanes;
+	bool listed = false;				// lanes, not alive, hold the truth
+	RandomBuffer rng;
+
+	void playLanes(Game& game, size_t g, size_t laneCount);
+	void playEach(Game& game, size_t g, size_t laneCount);
+public:
+	LaneTournaments(const std::vector<const Game*>& prototypes, const Population& start);
+	~LaneTournaments();
+
+	// Plays laneCount (at most LaneBlock::width) tournaments from the
+	// start population, all drawing from one buffer seeded with seed
+	void run(uint64_t seed, size_t laneCount);
+
+	// Statistics of every game in lane l of the last run
+	const std::vector<GameRecord>& getRecords(size_t lane) const { return records[lane]; }
+};
+
+// Plays many small tournaments in blocks of LaneBlock::width lanes spread
+// over the scheduler, and merges their results like InterleavedRunner.
+// Block b draws from seed + 1 + b, so results do not depend on the
+// number of threads, but they differ from the one-at-a-time runners.
+class LaneRunner
+{
+	std::vector<const Game*> games;
+	Population population;
+	uint64_t seed;
+
+	std::mutex mergeLock;
+	uint64_t runs = 0;
+	uint64_t cancelled = 0;
+	std::vector<uint64_t> initial, survivors, deaths;
+	std::vector<std::map<uint32_t, std::pair<uint64_t, CompactPlayer>>> wins;	// per game: number -> (wins, player)
+public:
+	LaneRunner(const std::vector<const Game*>& games, const Population& population, uint64_t seed);
+
+	// Plays totalRuns tournaments. maxSeconds of 0 means no limit; blocks
+	// that have not started when it passes are skipped.
+	void run(uint64_t totalRuns, TaskScheduler* scheduler, double maxSeconds = 0);
+
+	void applyTo(const std::vector<Game*>& games) const;
+	void printReport() const;
+
+	uint64_t getRunCount() const { return runs; }
+};
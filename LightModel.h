@@ -0,0 +1,301 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CompactPlayer.h"
+#include "Random.h"
+
+// Light phases for Red Light Green Light.
+// Times are in milliseconds; speeds are movingDistance() per second.
+struct LightOptions
+{
+	bool enabled = false;			// off: every turn is a move turn
+	unsigned int greenMin = 2000;	// green phase length range
+	unsigned int greenMax = 5000;
+	unsigned int redMin = 1500;		// red phase length range
+	unsigned int redMax = 4000;
+	unsigned int lookDelay = 400;	// the doll looks this long after red starts
+};
+
+// One scheduled happening; player is an index into the game's array
+struct LightEvent
+{
+	enum Type : uint8_t { Green, Red, Look, Stop, Escape, Caught, End };
+
+	uint32_t time;
+	uint32_t player;
+	Type type;
+};
+
+// Pending events in time order, equal times first in first out.
+// Small games use a binary heap. Large ones use a calendar queue with
+// one-millisecond buckets spanning more than any event is scheduled
+// ahead, so every bucket holds events of a single time and push and pop
+// are O(1). Buckets are linked lists in one node pool, so a reserved
+// queue never allocates. Both give the same order, so results do not
+// depend on which one is used.
+class LightEventQueue
+{
+	struct Entry
+	{
+		LightEvent event;
+		uint64_t sequence;
+		bool operator<(const Entry& other) const
+		{
+			// std::push_heap keeps the largest on top
+			return event.time != other.event.time ? event.time > other.event.time : sequence > other.sequence;
+		}
+	};
+
+	std::vector<Entry> heap;
+	uint64_t sequence = 0;
+
+	struct Node
+	{
+		LightEvent event;
+		uint32_t next;
+	};
+
+	static constexpr uint32_t none = UINT32_MAX;
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> heads;		// first and last node per bucket
+	std::vector<uint32_t> tails;
+	uint32_t freeNodes = none;
+	uint32_t now = 0;
+	size_t pending = 0;
+	bool calendar = false;
+public:
+	static const size_t calendarThreshold = 1 << 12;
+
+	// Empties the queue; horizon bounds how far ahead of the last popped
+	// event anything is pushed
+	void reset(size_t playerCount, uint32_t horizon)
+	{
+		heap.clear();
+		sequence = 0;
+		now = 0;
+		pending = 0;
+		calendar = playerCount > calendarThreshold;
+		if (!calendar)
+			return;
+
+		size_t count = 1;
+		while (count <= horizon)
+			count <<= 1;
+		nodes.clear();
+		freeNodes = none;
+		heads.assign(std::max(count, heads.size()), none);
+		tails.assign(heads.size(), none);
+	}
+
+	void reserve(size_t events)
+	{
+		heap.reserve(events);
+		nodes.reserve(events);
+	}
+
+	bool empty() const { return calendar ? pending == 0 : heap.empty(); }
+
+	void push(const LightEvent& event)
+	{
+		if (!calendar)
+		{
+			heap.push_back({ event, sequence++ });
+			std::push_heap(heap.begin(), heap.end());
+			return;
+		}
+		uint32_t node = freeNodes;
+		if (node != none)
+		{
+			freeNodes = nodes[node].next;
+			nodes[node] = { event, none };
+		}
+		else
+		{
+			node = uint32_t(nodes.size());
+			nodes.push_back({ event, none });
+		}
+
+		size_t bucket = event.time & (heads.size() - 1);
+		if (tails[bucket] == none)
+			heads[bucket] = node;
+		else
+			nodes[tails[bucket]].next = node;
+		tails[bucket] = node;
+		pending++;
+	}
+
+	LightEvent pop()
+	{
+		if (!calendar)
+		{
+			std::pop_heap(heap.begin(), heap.end());
+			LightEvent event = heap.back().event;
+			heap.pop_back();
+			return event;
+		}
+
+		size_t mask = heads.size() - 1;
+		while (heads[now & mask] == none)
+			now++;
+
+		size_t bucket = now & mask;
+		uint32_t node = heads[bucket];
+		heads[bucket] = nodes[node].next;
+		if (heads[bucket] == none)
+			tails[bucket] = none;
+
+		nodes[node].next = freeNodes;
+		freeNodes = node;
+		pending--;
+		return nodes[node].event;
+	}
+};
+
+// Player attributes the light model needs, for compact records and Player objects
+inline int lightAgility(const CompactPlayer& player) { return player.getAgility(); }
+inline int lightFearlessness(const CompactPlayer& player) { return player.getFearlessness(); }
+template <class P> int lightAgility(const P* player) { return player->getAgility(); }
+template <class P> int lightFearlessness(const P* player) { return player->getFearlessness(); }
+
+// Discrete-event Red Light Green Light.
+// Each green phase draws its own length and the red after it. Players
+// start walking a reaction delay after green, shorter for agile players,
+// and stop a reaction delay after red, longer for fearless ones. Anyone
+// still walking when the doll looks is caught; anyone who has not crossed
+// when the last red ends is out of time. A player's whole phase is decided
+// when the light turns green, so each phase costs one event per player
+// still on the field instead of one poll per player per tick.
+template <class Container>
+class LightModel
+{
+	LightOptions options;
+	LightEventQueue queue;
+	std::vector<uint64_t> walked;		// distance * 1000, by position
+	std::vector<uint32_t> waiting;
+	std::vector<uint32_t> nextWaiting;
+public:
+	LightModel(const LightOptions& options = LightOptions()) : options(options) {};
+
+	const LightOptions& getOptions() const { return options; }
+	void setOptions(const LightOptions& options) { this->options = options; }
+
+	void reserve(size_t playerCount)
+	{
+		walked.reserve(playerCount);
+		waiting.reserve(playerCount);
+		nextWaiting.reserve(playerCount);
+		queue.reserve(playerCount + 4);
+	}
+
+	// Milliseconds from green to the first step, and from red to standing still
+	static uint32_t startDelay(int agility, float roll) { return 150 + (100 - agility) * 3 + uint32_t(roll * 150); }
+	static uint32_t stopDelay(int agility, int fearlessness, float roll) { return 100 + (100 - agility) + fearlessness * 3 / 2 + uint32_t(roll * 150); }
+
+	// Plays phases green phases. Asks on.speed(index) for a player's speed,
+	// and calls on.light(event) for Green, Red, Look and End,
+	// on.escape(index, distance), on.caught(index) and on.timedOut(index)
+	// as they happen. Returns with every player either escaped or out.
+	template <class Listener>
+	void run(const Container& players, unsigned int phases, unsigned int distance, RandomBuffer& rng, Listener& on);
+};
+
+
+template <class Container>
+template <class Listener>
+void LightModel<Container>::run(const Container& players, unsigned int phases, unsigned int distance, RandomBuffer& rng, Listener& on)
+{
+	size_t count = players.size();
+	const uint64_t goal = uint64_t(distance) * 1000;
+
+	walked.assign(count, 0);
+	waiting.resize(count);
+	for (size_t i = 0; i < count; ++i)
+		waiting[i] = uint32_t(i);
+	nextWaiting.clear();
+
+	// Nothing is pushed further ahead than one whole phase plus a delay
+	uint32_t horizon = options.greenMax + options.redMax + options.lookDelay + stopDelay(0, 100, 1.0f);
+	queue.reset(count, horizon);
+	queue.push({ 0, 0, phases > 0 ? LightEvent::Green : LightEvent::End });
+
+	unsigned int phase = 0;
+	while (!queue.empty())
+	{
+		LightEvent event = queue.pop();
+		uint32_t i = event.player;
+
+		// Everyone is across or out, so no more lights are needed
+		if (event.type == LightEvent::Green && waiting.empty())
+			event.type = LightEvent::End;
+
+		switch (event.type)
+		{
+		case LightEvent::Green:
+		{
+			phase++;
+			uint32_t redAt = event.time + options.greenMin + rng.nextBelow(options.greenMax - options.greenMin + 1);
+			uint32_t lookAt = redAt + options.lookDelay;
+			uint32_t next = redAt + options.redMin + rng.nextBelow(options.redMax - options.redMin + 1);
+
+			queue.push({ redAt, 0, LightEvent::Red });
+			queue.push({ lookAt, 0, LightEvent::Look });
+			queue.push({ next, 0, phase < phases ? LightEvent::Green : LightEvent::End });
+
+			// Each player's phase ends in one event: crossing the line,
+			// standing still in time, or being seen. Those too slow to
+			// react before red sit this phase out.
+			nextWaiting.clear();
+			for (uint32_t w : waiting)
+			{
+				int agility = lightAgility(players[w]);
+				uint32_t start = event.time + startDelay(agility, rng.nextProbability());
+				if (start >= redAt)
+				{
+					nextWaiting.push_back(w);
+					continue;
+				}
+
+				uint64_t speed = std::max(1u, on.speed(w));
+				uint32_t stop = redAt + stopDelay(agility, lightFearlessness(players[w]), rng.nextProbability());
+				uint64_t arrive = start + (goal - walked[w] + speed - 1) / speed;
+
+				if (arrive <= std::min(stop, lookAt))
+					queue.push({ uint32_t(arrive), w, LightEvent::Escape });
+				else if (stop <= lookAt)
+				{
+					walked[w] += speed * (stop - start);
+					queue.push({ stop, w, LightEvent::Stop });
+				}
+				else
+					queue.push({ lookAt, w, LightEvent::Caught });
+			}
+			waiting.swap(nextWaiting);
+			on.light(event);
+			break;
+		}
+		case LightEvent::Stop:
+			waiting.push_back(i);
+			break;
+		case LightEvent::Escape:
+			on.escape(i, distance);
+			break;
+		case LightEvent::Caught:
+			on.caught(i);
+			break;
+		case LightEvent::End:
+			on.light(event);
+			for (uint32_t w : waiting)
+			{
+				on.timedOut(w);
+			}
+			waiting.clear();
+			break;
+		default:
+			on.light(event);
+			break;
+		}
+	}
+}
@@ -0,0 +1,308 @@
+#include <cstdio>
+#include <memory>
+#include "Metrics.h"
+#include "Scheduler.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define METRICS_HTTP
+#endif
+
+std::atomic<bool> Metrics::enabled{ false };
+
+namespace
+{
+	std::mutex blocksLock;
+	std::vector<std::unique_ptr<Metrics::Block>> blocks;
+	thread_local Metrics::Block* current = nullptr;
+
+	void appendValue(std::string& text, const char* name, const std::string& labels, double value)
+	{
+		char number[32];
+		snprintf(number, sizeof(number), "%.17g", value);
+		text += name;
+		if (!labels.empty())
+			text += "{" + labels + "}";
+		text += " ";
+		text += number;
+		text += "\n";
+	}
+
+	void appendHeader(std::string& text, const char* name, const char* type, const char* help)
+	{
+		text += std::string("# HELP ") + name + " " + help + "\n";
+		text += std::string("# TYPE ") + name + " " + type + "\n";
+	}
+}
+
+Metrics::Block& Metrics::local()
+{
+	if (!current)
+	{
+		std::lock_guard<std::mutex> hold(blocksLock);
+		blocks.emplace_back(new Block());
+		current = blocks.back().get();
+	}
+	return *current;
+}
+
+Metrics::Totals Metrics::collect()
+{
+	Totals totals;
+	std::lock_guard<std::mutex> hold(blocksLock);
+	for (auto& block : blocks)
+	{
+		totals.runs += block->runs.load(std::memory_order_relaxed);
+		totals.randomWords += block->randomWords.load(std::memory_order_relaxed);
+		totals.allocations += block->allocations.load(std::memory_order_relaxed);
+		totals.allocatedBytes += block->allocatedBytes.load(std::memory_order_relaxed);
+		for (size_t g = 0; g < maxGames; ++g)
+		{
+			totals.initial[g] += block->initial[g].load(std::memory_order_relaxed);
+			totals.survivors[g] += block->survivors[g].load(std::memory_order_relaxed);
+		}
+	}
+	return totals;
+}
+
+MetricsExporter::MetricsExporter(const std::vector<std::string>& gameNames, const TaskScheduler* scheduler)
+	: gameNames(gameNames), scheduler(scheduler)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+	stop();
+}
+
+bool MetricsExporter::start(const std::string& path, unsigned int port, double intervalSeconds)
+{
+	this->path = path;
+	interval = intervalSeconds > 0 ? intervalSeconds : 1.0;
+
+	if (port != 0)
+	{
+#ifdef METRICS_HTTP
+		listener = socket(AF_INET, SOCK_STREAM, 0);
+		int reuse = 1;
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+		// Loopback only: the counters are for whoever runs the campaign
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(uint16_t(port));
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+			|| listen(listener, 16) != 0)
+		{
+			if (listener >= 0)
+				close(listener);
+			listener = -1;
+			return false;
+		}
+#else
+		return false;
+#endif
+	}
+
+	Metrics::enable();
+	startTime = lastTime = std::chrono::steady_clock::now();
+	lastRuns = 0;
+	sample();
+	write();
+	thread = std::thread([this]() { exportLoop(); });
+	return true;
+}
+
+void MetricsExporter::stop()
+{
+	if (!thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> hold(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+	thread.join();
+
+	sample();
+	write();
+
+#ifdef METRICS_HTTP
+	if (listener >= 0)
+		close(listener);
+#endif
+	listener = -1;
+}
+
+void MetricsExporter::exportLoop()
+{
+	auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval));
+	auto next = std::chrono::steady_clock::now();
+	for (;;)
+	{
+		next += period;
+		if (listener >= 0)
+			serve(next);
+		else
+		{
+			std::unique_lock<std::mutex> hold(lock);
+			wake.wait_until(hold, next, [this]() { return stopping; });
+		}
+
+		{
+			std::lock_guard<std::mutex> hold(lock);
+			if (stopping)
+				return;
+		}
+		sample();
+		write();
+	}
+}
+
+// Builds the text of the current counters
+void MetricsExporter::sample()
+{
+	Metrics::Totals totals = Metrics::collect();
+	auto now = std::chrono::steady_clock::now();
+	double elapsed = std::chrono::duration<double>(now - startTime).count();
+	double sinceLast = std::chrono::duration<double>(now - lastTime).count();
+	double rate = sinceLast > 0 ? (totals.runs - lastRuns) / sinceLast : 0.0;
+	lastTime = now;
+	lastRuns = totals.runs;
+
+	std::string out;
+	appendHeader(out, "squid_uptime_seconds", "gauge", "Seconds since the exporter started.");
+	appendValue(out, "squid_uptime_seconds", "", elapsed);
+
+	appendHeader(out, "squid_runs_total", "counter", "Tournaments completed.");
+	appendValue(out, "squid_runs_total", "", double(totals.runs));
+
+	appendHeader(out, "squid_runs_per_second", "gauge", "Tournaments completed per second over the last interval.");
+	appendValue(out, "squid_runs_per_second", "", rate);
+
+	size_t games = gameNames.size() < Metrics::maxGames ? gameNames.size() : Metrics::maxGames;
+
+	appendHeader(out, "squid_game_players_total", "counter", "Players who entered each game, summed over runs.");
+	for (size_t g = 0; g < games; ++g)
+		appendValue(out, "squid_game_players_total", "game=\"" + gameNames[g] + "\"", double(totals.initial[g]));
+
+	appendHeader(out, "squid_game_survivors_total", "counter", "Survivors of each game, summed over runs.");
+	for (size_t g = 0; g < games; ++g)
+		appendValue(out, "squid_game_survivors_total", "game=\"" + gameNames[g] + "\"", double(totals.survivors[g]));
+
+	appendHeader(out, "squid_game_survivors_mean", "gauge", "Mean survivors of each game per run.");
+	for (size_t g = 0; g < games; ++g)
+		appendValue(out, "squid_game_survivors_mean", "game=\"" + gameNames[g] + "\"",
+			totals.runs > 0 ? double(totals.survivors[g]) / totals.runs : 0.0);
+
+	appendHeader(out, "squid_game_survival_ratio", "gauge", "Survivors over entrants of each game.");
+	for (size_t g = 0; g < games; ++g)
+		appendValue(out, "squid_game_survival_ratio", "game=\"" + gameNames[g] + "\"",
+			totals.initial[g] > 0 ? double(totals.survivors[g]) / totals.initial[g] : 0.0);
+
+	appendHeader(out, "squid_random_words_total", "counter", "32-bit random words generated.");
+	appendValue(out, "squid_random_words_total", "", double(totals.randomWords));
+
+	appendHeader(out, "squid_allocations_total", "counter", "Engine buffers and objects allocated through NodeAllocator and NodeArena.");
+	appendValue(out, "squid_allocations_total", "", double(totals.allocations));
+
+	appendHeader(out, "squid_allocated_bytes_total", "counter", "Bytes of those allocations.");
+	appendValue(out, "squid_allocated_bytes_total", "", double(totals.allocatedBytes));
+
+	if (scheduler)
+	{
+		appendHeader(out, "squid_scheduler_queued_tasks", "gauge", "Tasks waiting in the scheduler deques.");
+		appendValue(out, "squid_scheduler_queued_tasks", "", double(scheduler->getQueuedTasks()));
+
+		appendHeader(out, "squid_scheduler_threads", "gauge", "Scheduler participants, including the caller.");
+		appendValue(out, "squid_scheduler_threads", "", double(scheduler->getConcurrency()));
+	}
+
+	std::lock_guard<std::mutex> hold(lock);
+	text.swap(out);
+}
+
+// Replaces the file through a rename, so a reader sees the old or the new sample
+void MetricsExporter::write() const
+{
+	if (path.empty())
+		return;
+
+	std::string temporary = path + ".tmp";
+	FILE* file = fopen(temporary.c_str(), "wb");
+	if (!file)
+		return;
+	fwrite(text.data(), 1, text.size(), file);
+	bool written = fclose(file) == 0;
+	if (written)
+		std::rename(temporary.c_str(), path.c_str());
+}
+
+// Answers scrapes until the given time or until stopped.
+// Every request gets the latest sample, whatever its path.
+void MetricsExporter::serve(std::chrono::steady_clock::time_point until)
+{
+#ifdef METRICS_HTTP
+	for (;;)
+	{
+		{
+			std::lock_guard<std::mutex> hold(lock);
+			if (stopping)
+				return;
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if (now >= until)
+			return;
+
+		// Short slices so stop() never waits a whole interval
+		auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - now).count();
+		pollfd waiting = { listener, POLLIN, 0 };
+		if (poll(&waiting, 1, int(remaining < 100 ? remaining + 1 : 100)) <= 0)
+			continue;
+
+		int client = accept(listener, nullptr, nullptr);
+		if (client < 0)
+			continue;
+
+		// The request itself does not matter; read what has arrived and answer
+		char request[4096];
+		pollfd reading = { client, POLLIN, 0 };
+		if (poll(&reading, 1, 1000) > 0)
+			recv(client, request, sizeof(request), 0);
+
+		std::string body;
+		{
+			std::lock_guard<std::mutex> hold(lock);
+			body = text;
+		}
+		std::string response = "HTTP/1.0 200 OK\r\n"
+			"Content-Type: text/plain; version=0.0.4\r\n"
+			"Content-Length: " + std::to_string(body.size()) + "\r\n"
+			"Connection: close\r\n\r\n" + body;
+
+#ifdef MSG_NOSIGNAL
+		const int flags = MSG_NOSIGNAL;
+#else
+		const int flags = 0;
+#endif
+		size_t sent = 0;
+		while (sent < response.size())
+		{
+			ssize_t count = send(client, response.data() + sent, response.size() - sent, flags);
+			if (count <= 0)
+				break;
+			sent += size_t(count);
+		}
+		close(client);
+	}
+#else
+	(void)until;
+#endif
+}
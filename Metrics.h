@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TaskScheduler;
+
+// Live campaign counters.
+// Every thread counts into its own cache-line aligned block that only it
+// writes, so the hot loops never share a line or take a lock; a counter
+// update is a relaxed load and store. The exporter sums the blocks while
+// they are being written. Blocks outlive their threads, so nothing counted
+// is lost when a pool shuts down. Nothing is counted until enable().
+class Metrics
+{
+public:
+	static const size_t maxGames = 16;
+
+	struct alignas(64) Block
+	{
+		std::atomic<uint64_t> runs;
+		std::atomic<uint64_t> randomWords;
+		std::atomic<uint64_t> allocations;
+		std::atomic<uint64_t> allocatedBytes;
+		std::atomic<uint64_t> initial[maxGames];
+		std::atomic<uint64_t> survivors[maxGames];
+
+		void addRun() { add(runs, 1); }
+		void addRandomWords(uint64_t count) { add(randomWords, count); }
+		void addAllocation(uint64_t bytes)
+		{
+			add(allocations, 1);
+			add(allocatedBytes, bytes);
+		}
+		void addGame(size_t game, uint64_t initialCount, uint64_t survivorCount)
+		{
+			if (game >= maxGames)
+				return;
+			add(initial[game], initialCount);
+			add(survivors[game], survivorCount);
+		}
+	};
+
+	// Sums of every block
+	struct Totals
+	{
+		uint64_t runs = 0;
+		uint64_t randomWords = 0;
+		uint64_t allocations = 0;
+		uint64_t allocatedBytes = 0;
+		uint64_t initial[maxGames] = {};
+		uint64_t survivors[maxGames] = {};
+	};
+
+	static void enable() { enabled.store(true, std::memory_order_relaxed); }
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+	// The calling thread's block, registered on first use
+	static Block& local();
+
+	static Totals collect();
+
+private:
+	// Only the owning thread writes a counter, so no read-modify-write is needed
+	static void add(std::atomic<uint64_t>& counter, uint64_t value)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	static std::atomic<bool> enabled;
+};
+
+// Writes the counters in the Prometheus text format every interval, to a
+// file that is replaced atomically so readers never see half of one, and
+// optionally serves the latest sample over HTTP on 127.0.0.1.
+class MetricsExporter
+{
+	std::vector<std::string> gameNames;
+	const TaskScheduler* scheduler;
+	std::string path;
+	double interval = 1.0;
+	int listener = -1;
+
+	std::thread thread;
+	std::mutex lock;
+	std::condition_variable wake;
+	bool stopping = false;
+	std::string text;		// latest sample
+
+	std::chrono::steady_clock::time_point startTime;
+	std::chrono::steady_clock::time_point lastTime;
+	uint64_t lastRuns = 0;
+
+	void sample();
+	void write() const;
+	void serve(std::chrono::steady_clock::time_point until);
+	void exportLoop();
+public:
+	MetricsExporter(const std::vector<std::string>& gameNames, const TaskScheduler* scheduler);
+	~MetricsExporter();
+
+	// Starts exporting to path (may be empty) and, with a nonzero port, serving
+	// on 127.0.0.1:port. Returns false if the port cannot be bound.
+	bool start(const std::string& path, unsigned int port, double intervalSeconds);
+
+	// Stops the exporter thread and writes one last sample
+	void stop();
+};
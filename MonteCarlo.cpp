@@ -0,0 +1,183 @@
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "MonteCarlo.h"
+#include "Tournament.h"
+#include "Scheduler.h"
+#include "Game.h"
+
+// Combines two estimates as if every sample had been added to one
+void RunningEstimate::merge(const RunningEstimate& other)
+{
+	count += other.count;
+	sum += other.sum;
+	sumSquares += other.sumSquares;
+}
+
+double RunningEstimate::getVariance() const
+{
+	if (count < 2)
+		return 0.0;
+
+	double mean = getMean();
+	double variance = (sumSquares - count * mean * mean) / (count - 1);
+	return variance > 0.0 ? variance : 0.0;
+}
+
+double RunningEstimate::getHalfWidth(double z, bool proportion) const
+{
+	if (count == 0)
+		return INFINITY;
+
+	double n = double(count);
+	if (proportion)
+	{
+		double p = getMean();
+		return z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / (1.0 + z * z / n);
+	}
+	return z * std::sqrt(getVariance() / n);
+}
+
+
+AdaptiveMonteCarlo::AdaptiveMonteCarlo(const std::vector<const Game*>& games, const Population& population, uint64_t seed)
+	: games(games), population(population), seed(seed)
+{
+}
+
+AdaptiveMonteCarlo::~AdaptiveMonteCarlo()
+{
+}
+
+// Plays runs [first, first + count) as jobs of jobSize runs on the scheduler.
+// Each slot keeps its own runner and partial estimates; run r always uses
+// seed + r, so results do not depend on which thread plays it.
+void AdaptiveMonteCarlo::runBatch(TaskScheduler& scheduler, uint64_t first, uint64_t count, uint64_t jobSize, ResultWriter* writer)
+{
+	size_t slots = scheduler.getConcurrency();
+	std::vector<std::vector<RunningEstimate>> partial(slots, std::vector<RunningEstimate>(metrics.size()));
+
+	auto job = [&](uint64_t begin, uint64_t end) {
+		size_t slot = scheduler.currentSlot();
+		if (!runners[slot])
+		{
+			runners[slot].reset(new TournamentRunner(games));
+			runners[slot]->setScheduler(&scheduler);
+		}
+
+		if (writer && !buffers[slot])
+			buffers[slot].reset(new ResultWriter::Buffer(*writer));
+
+		TournamentRunner& runner = *runners[slot];
+		std::vector<RunningEstimate>& local = partial[slot];
+
+		for (uint64_t r = begin; r < end; ++r)
+		{
+			runner.run(population, seed + r);
+
+			const std::vector<GameRecord>& records = runner.getRecords();
+			if (writer)
+				buffers[slot]->add(r, records);
+
+			for (size_t g = 0; g < records.size(); ++g)
+			{
+				if (records[g].initial_count > 0)
+					local[g].add(double(records[g].death_count) / records[g].initial_count);
+			}
+
+			int winner = records.empty() ? 0 : records.back().winner.getNumber();
+			for (size_t p = 0; p < trackedPlayers.size(); ++p)
+				local[records.size() + p].add(winner == trackedPlayers[p] ? 1.0 : 0.0);
+		}
+	};
+
+	scheduler.parallelFor(first, first + count, jobSize, job);
+
+	for (size_t t = 0; t < slots; ++t)
+		for (size_t m = 0; m < metrics.size(); ++m)
+			metrics[m].estimate.merge(partial[t][m]);
+}
+
+void AdaptiveMonteCarlo::run(const AdaptiveOptions& options)
+{
+	metrics.clear();
+	for (auto game : games)
+	{
+		MetricReport metric;
+		metric.name = game->getName() + " death rate";
+		metrics.push_back(metric);
+	}
+	for (int number : trackedPlayers)
+	{
+		MetricReport metric;
+		metric.name = "Player #" + std::to_string(number) + " win probability";
+		metric.proportion = true;
+		metrics.push_back(metric);
+	}
+
+	TaskScheduler& scheduler = options.scheduler ? *options.scheduler : TaskScheduler::shared();
+	runners.clear();
+	runners.resize(scheduler.getConcurrency());
+	buffers.clear();
+	buffers.resize(scheduler.getConcurrency());
+
+	auto start = std::chrono::steady_clock::now();
+	z = options.z;
+	runs = 0;
+	converged = false;
+
+	while (!converged && runs < options.maxRuns)
+	{
+		uint64_t count = options.batchSize;
+		if (count > options.maxRuns - runs)
+			count = options.maxRuns - runs;
+
+		runBatch(scheduler, runs, count, options.jobSize, options.writer);
+		runs += count;
+
+		// A metric counts as done the first time its interval is narrow enough
+		converged = true;
+		for (auto& metric : metrics)
+		{
+			if (metric.runsNeeded == 0 && runs >= options.minRuns
+				&& 2.0 * metric.estimate.getHalfWidth(options.z, metric.proportion) < options.targetWidth)
+				metric.runsNeeded = runs;
+
+			if (metric.runsNeeded == 0)
+				converged = false;
+		}
+
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (elapsed.count() >= options.maxSeconds)
+			break;
+	}
+
+	// Flushes the last partial block of every slot
+	buffers.clear();
+}
+
+// Prints every metric with its interval and the runs it needed
+void AdaptiveMonteCarlo::printReport() const
+{
+	std::cout << "\n================ Adaptive Monte Carlo ================\n";
+	std::cout << "| Metric | Estimate | CI (+/-) | Samples | Runs Needed |\n";
+	std::cout << "---------------------------------------------\n";
+
+	for (auto& metric : metrics)
+	{
+		std::cout << "| " << metric.name
+			<< " | " << metric.estimate.getMean() * 100.0f << "% "
+			<< " | " << metric.estimate.getHalfWidth(z, metric.proportion) * 100.0f << "% "
+			<< " | " << metric.estimate.getCount()
+			<< " | ";
+
+		if (metric.runsNeeded)
+			std::cout << metric.runsNeeded;
+		else
+			std::cout << "not reached";
+
+		std::cout << " |" << std::endl;
+	}
+
+	std::cout << (converged ? "All metrics reached the target after " : "Budget exhausted after ")
+		<< runs << " runs." << std::endl;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "CompactPlayer.h"
+#include "Export.h"
+
+class Game;
+class TournamentRunner;
+class TaskScheduler;
+
+// Running mean and variance of one estimated quantity
+class RunningEstimate
+{
+	uint64_t count = 0;
+	double sum = 0;
+	double sumSquares = 0;
+public:
+	void add(double x) { count++; sum += x; sumSquares += x * x; }
+	void merge(const RunningEstimate& other);
+
+	uint64_t getCount() const { return count; }
+	double getMean() const { return count ? sum / count : 0.0; }
+	double getVariance() const;
+
+	// Half width of the confidence interval for z standard errors.
+	// Proportions use the Wilson interval, which stays sensible near 0 and 1.
+	double getHalfWidth(double z, bool proportion) const;
+};
+
+// Stopping rule and budget for AdaptiveMonteCarlo::run()
+struct AdaptiveOptions
+{
+	double targetWidth = 0.01;		// full confidence interval width to reach
+	double z = 1.96;				// 95% confidence
+	uint64_t batchSize = 1000;		// runs launched between checks
+	uint64_t minRuns = 100;			// never stop before this many runs
+	uint64_t maxRuns = 100000000;
+	double maxSeconds = 60.0;
+	uint64_t jobSize = 16;			// runs per scheduled task
+	TaskScheduler* scheduler = nullptr;	// nullptr = TaskScheduler::shared()
+	ResultWriter* writer = nullptr;		// receives every run's records when set
+};
+
+// Result for one metric
+struct MetricReport
+{
+	std::string name;
+	bool proportion = false;
+	RunningEstimate estimate;
+	uint64_t runsNeeded = 0;		// runs when the interval first met the target, 0 if never
+};
+
+// Keeps launching batches of tournaments until every metric's confidence
+// interval is narrower than the target, or the run/time budget runs out.
+// Metrics are the death rate of every game and the win probability of
+// each tracked player.
+class AdaptiveMonteCarlo
+{
+	std::vector<const Game*> games;
+	Population population;
+	uint64_t seed;
+	std::vector<int> trackedPlayers;
+
+	std::vector<MetricReport> metrics;
+	uint64_t runs = 0;
+	bool converged = false;
+	double z = 1.96;
+
+	// Per slot: a runner and, when exporting, a write buffer
+	std::vector<std::unique_ptr<TournamentRunner>> runners;
+	std::vector<std::unique_ptr<ResultWriter::Buffer>> buffers;
+
+	void runBatch(TaskScheduler& scheduler, uint64_t first, uint64_t count, uint64_t jobSize, ResultWriter* writer);
+public:
+	AdaptiveMonteCarlo(const std::vector<const Game*>& games, const Population& population, uint64_t seed);
+	~AdaptiveMonteCarlo();
+
+	void trackWinner(int number) { trackedPlayers.push_back(number); }
+	void run(const AdaptiveOptions& options);
+
+	uint64_t getRuns() const { return runs; }
+	bool isConverged() const { return converged; }
+	const std::vector<MetricReport>& getMetrics() const { return metrics; }
+	void printReport() const;
+};
@@ -0,0 +1,298 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "Numa.h"
+#include "Metrics.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Parses a kernel CPU list such as "0-3,8,10-11"
+static std::vector<int> parseCpuList(const char* text)
+{
+	std::vector<int> cpus;
+	while (*text)
+	{
+		char* end;
+		long first = strtol(text, &end, 10);
+		if (end == text)
+			break;
+
+		long last = first;
+		if (*end == '-')
+			last = strtol(end + 1, &end, 10);
+
+		for (long cpu = first; cpu <= last; ++cpu)
+			cpus.push_back(int(cpu));
+
+		text = (*end == ',') ? end + 1 : end;
+	}
+	return cpus;
+}
+
+const NumaTopology& NumaTopology::system()
+{
+	static NumaTopology topology = [] {
+		NumaTopology result;
+
+#ifdef __linux__
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+		if (DIR* dir = opendir("/sys/devices/system/node"))
+		{
+			std::vector<int> ids;
+			while (dirent* entry = readdir(dir))
+			{
+				int id;
+				if (sscanf(entry->d_name, "node%d", &id) == 1)
+					ids.push_back(id);
+			}
+			closedir(dir);
+			std::sort(ids.begin(), ids.end());
+
+			for (int id : ids)
+			{
+				char path[64], list[4096] = "";
+				snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+				if (FILE* file = fopen(path, "r"))
+				{
+					if (!fgets(list, sizeof(list), file))
+						list[0] = 0;
+					fclose(file);
+				}
+
+				std::vector<int> cpus;
+				for (int cpu : parseCpuList(list))
+				{
+					if (!haveMask || CPU_ISSET(cpu, &allowed))
+						cpus.push_back(cpu);
+				}
+
+				// Memory-only nodes and nodes outside our mask get no workers
+				if (!cpus.empty())
+				{
+					result.nodeIds.push_back(id);
+					result.nodeCpus.push_back(cpus);
+				}
+			}
+		}
+
+		if (result.nodeCpus.empty() && haveMask)
+		{
+			std::vector<int> cpus;
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+			{
+				if (CPU_ISSET(cpu, &allowed))
+					cpus.push_back(cpu);
+			}
+			result.nodeIds.push_back(0);
+			result.nodeCpus.push_back(cpus);
+		}
+#endif
+
+		if (result.nodeCpus.empty())
+		{
+			result.nodeIds.push_back(0);
+			result.nodeCpus.push_back(std::vector<int>(1, 0));
+		}
+		return result;
+	}();
+
+	return topology;
+}
+
+std::vector<int> NumaTopology::getCpuOrder() const
+{
+	std::vector<int> order;
+	for (auto& cpus : nodeCpus)
+		order.insert(order.end(), cpus.begin(), cpus.end());
+	return order;
+}
+
+int NumaTopology::getNodeOfCpu(int cpu) const
+{
+	for (size_t node = 0; node < nodeCpus.size(); ++node)
+	{
+		if (std::find(nodeCpus[node].begin(), nodeCpus[node].end(), cpu) != nodeCpus[node].end())
+			return nodeIds[node];
+	}
+	return -1;
+}
+
+bool pinCurrentThread(int cpu)
+{
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	return false;
+#endif
+}
+
+
+static thread_local int threadNode = -1;
+
+int NodeArena::currentNode()
+{
+	return threadNode;
+}
+
+void NodeArena::setCurrentNode(int node)
+{
+	threadNode = node;
+}
+
+// One arena per node id, plus one for unpinned threads
+NodeArena& NodeArena::forNode(int node)
+{
+	static std::mutex arenasLock;
+	static std::map<int, std::unique_ptr<NodeArena>> arenas;
+
+	std::lock_guard<std::mutex> guard(arenasLock);
+	std::unique_ptr<NodeArena>& arena = arenas[node];
+	if (!arena)
+		arena.reset(new NodeArena(node));
+	return *arena;
+}
+
+// Every block starts with this header; callers get the memory after it
+struct BlockHeader
+{
+	NodeArena* arena;
+	size_t size;
+};
+
+static const size_t headerSize = 64;
+
+// Blocks handed out by every arena; they are large, so sharing is cheap
+static std::atomic<uint64_t> arenaBlocks{ 0 };
+
+uint64_t NodeArena::getBlockCount()
+{
+	return arenaBlocks.load(std::memory_order_relaxed);
+}
+
+void* NodeArena::allocate(size_t bytes)
+{
+	arenaBlocks.fetch_add(1, std::memory_order_relaxed);
+	size_t size = bytes + headerSize;
+	char* block = nullptr;
+
+	{
+		// Reuse a cached block that is not much larger than needed
+		std::lock_guard<std::mutex> guard(lock);
+		auto cached = freeBlocks.lower_bound(size);
+		if (cached != freeBlocks.end() && cached->first <= 2 * size)
+		{
+			block = static_cast<char*>(cached->second);
+			size = cached->first;
+			freeBlocks.erase(cached);
+			cachedBlocks--;
+			cachedBytes -= size;
+		}
+	}
+
+	if (!block)
+	{
+#ifdef __linux__
+		void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapped == MAP_FAILED)
+			throw std::bad_alloc();
+		block = static_cast<char*>(mapped);
+
+		// MPOL_PREFERRED: place on this node, fall back elsewhere when it is full.
+		// Kernels without NUMA support reject the call and first touch decides.
+		if (node >= 0 && node < 64)
+		{
+			unsigned long mask = 1ul << node;
+			syscall(SYS_mbind, block, size, 1 /* MPOL_PREFERRED */, &mask, sizeof(mask) * 8 + 1, 0);
+		}
+#else
+		block = static_cast<char*>(::operator new(size));
+#endif
+		// First touch from the allocating thread commits the pages on its node
+		for (size_t offset = 0; offset < size; offset += 4096)
+			block[offset] = 0;
+	}
+
+	BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+	header->arena = this;
+	header->size = size;
+	return block + headerSize;
+}
+
+// Returns a block to the arena it came from, or unmaps it when the cache is full
+void NodeArena::release(void* pointer)
+{
+	if (!pointer)
+		return;
+
+	char* block = static_cast<char*>(pointer) - headerSize;
+	BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+	NodeArena& arena = *header->arena;
+	size_t size = header->size;
+
+	{
+		std::lock_guard<std::mutex> guard(arena.lock);
+		if (arena.cachedBlocks < maxCachedBlocks && arena.cachedBytes + size <= maxCachedBytes)
+		{
+			arena.freeBlocks.insert(std::make_pair(size, static_cast<void*>(block)));
+			arena.cachedBlocks++;
+			arena.cachedBytes += size;
+			return;
+		}
+	}
+
+#ifdef __linux__
+	munmap(block, size);
+#else
+	::operator delete(block);
+#endif
+}
+
+// Heap blocks get a header with no arena, so releaseLocal() can tell.
+// Both kinds of block are 64-byte aligned, as RandomBuffer needs.
+void* NodeArena::allocateLocal(size_t bytes)
+{
+	count(bytes);
+	int node = currentNode();
+	if (node >= 0 && bytes >= minBlock)
+		return forNode(node).allocate(bytes);
+
+	char* block = static_cast<char*>(::operator new(bytes + headerSize, std::align_val_t(headerSize)));
+	BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+	header->arena = nullptr;
+	header->size = bytes + headerSize;
+	return block + headerSize;
+}
+
+void NodeArena::count(size_t bytes)
+{
+	if (Metrics::isEnabled())
+		Metrics::local().addAllocation(bytes);
+}
+
+void NodeArena::releaseLocal(void* pointer)
+{
+	if (!pointer)
+		return;
+
+	char* block = static_cast<char*>(pointer) - headerSize;
+	if (reinterpret_cast<BlockHeader*>(block)->arena)
+		release(pointer);
+	else
+		::operator delete(block, std::align_val_t(headerSize));
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// NUMA nodes and their CPUs, read from /sys/devices/system/node.
+// Machines without that information look like one node holding every CPU
+// this process may run on.
+class NumaTopology
+{
+	std::vector<std::vector<int>> nodeCpus;
+	std::vector<int> nodeIds;
+public:
+	static const NumaTopology& system();
+
+	size_t getNodeCount() const { return nodeCpus.size(); }
+	int getNodeId(size_t node) const { return nodeIds[node]; }
+	const std::vector<int>& getCpus(size_t node) const { return nodeCpus[node]; }
+
+	// CPUs ordered node by node, so consecutive workers share a node
+	std::vector<int> getCpuOrder() const;
+	int getNodeOfCpu(int cpu) const;
+};
+
+// Pins the calling thread to one CPU; false if the system refused
+bool pinCurrentThread(int cpu);
+
+// Large-block arena for one NUMA node.
+// Blocks are mapped, bound to the node where the kernel allows it and
+// first touched by the thread that asked for them; freed blocks are kept
+// for reuse by later runs on the same node, up to maxCachedBytes per node.
+class NodeArena
+{
+	int node;
+	std::mutex lock;
+	std::multimap<size_t, void*> freeBlocks;
+	size_t cachedBlocks = 0;
+	size_t cachedBytes = 0;
+
+	static const size_t maxCachedBlocks = 64;
+	static const size_t maxCachedBytes = size_t(256) << 20;
+
+	NodeArena(int node) : node(node) {};
+public:
+	// Blocks at least this large come from an arena; smaller ones use operator new
+	static const size_t minBlock = size_t(1) << 20;
+
+	static NodeArena& forNode(int node);
+
+	// Node of the calling thread, -1 when it is not pinned
+	static int currentNode();
+	static void setCurrentNode(int node);
+
+	void* allocate(size_t bytes);
+	static void release(void* pointer);
+
+	// Blocks allocate() has handed out so far, mapped or reused. They never
+	// pass through operator new, so allocation checks add them separately.
+	static uint64_t getBlockCount();
+
+	// Objects owned by the calling thread, aligned to 64 bytes: from its
+	// node's arena when it is pinned and the object is at least minBlock,
+	// from operator new otherwise, where a pinned thread's first touch
+	// places small objects on its node without a mapping of their own.
+	// Either way freed with releaseLocal().
+	static void* allocateLocal(size_t bytes);
+	static void releaseLocal(void* pointer);
+
+	// Counts an engine allocation in the calling thread's metrics block;
+	// only a flag test while metrics are off
+	static void count(size_t bytes);
+};
+
+// std allocator that places large buffers on the calling thread's node
+template <class T>
+struct NodeAllocator
+{
+	typedef T value_type;
+
+	NodeAllocator() {};
+	template <class U> NodeAllocator(const NodeAllocator<U>&) {};
+
+	T* allocate(size_t n)
+	{
+		size_t bytes = n * sizeof(T);
+		NodeArena::count(bytes);
+		if (bytes < NodeArena::minBlock)
+			return static_cast<T*>(::operator new(bytes));
+		return static_cast<T*>(NodeArena::forNode(NodeArena::currentNode()).allocate(bytes));
+	}
+
+	void deallocate(T* pointer, size_t n)
+	{
+		if (n * sizeof(T) < NodeArena::minBlock)
+			::operator delete(pointer);
+		else
+			NodeArena::release(pointer);
+	}
+
+	template <class U> bool operator==(const NodeAllocator<U>&) const { return true; }
+	template <class U> bool operator!=(const NodeAllocator<U>&) const { return false; }
+};
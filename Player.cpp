@@ -1,11 +1,8 @@
 ﻿#include "Player.h"
 #include "Game.h"
-// Initialize random engine with current time for non-deterministic behavior
-std::default_random_engine Player::random_engine(time(nullptr));
-// Ability values are uniformly distributed between 0 and 100
-std::uniform_int_distribution<unsigned int> Player::ability_range(0, 100);
-// Probability generator for all random decisions (0.0 ~ 1.0)
-std::uniform_real_distribution<float> Player::possibility(0.f, 1.f);
+// Initialize the shared random buffer with current time for non-deterministic behavior.
+// All random decisions (0.0 ~ 1.0) and abilities are drawn from it.
+RandomBuffer Player::random_buffer(time(nullptr));
 
 float PlayerRLGL::fallDownRate = 0.1f;
 
@@ -16,8 +13,9 @@ Player::Player(int number)
 {
 	this->number = number;
 
-	agility = ability_range(random_engine);
-	fearlessness = ability_range(random_engine);
+	// Ability values are uniformly distributed between 0 and 100
+	agility = random_buffer.nextBelow(101);
+	fearlessness = random_buffer.nextBelow(101);
 }
 
 // Constructs a player with fixed abilities (used for testing or final winner display)
@@ -34,21 +32,29 @@ Player::Player(int number, int agility, int fearlessness)
 
 bool PlayerRLGL::act()
 {
-	// Calculate movement distance based on agility, player number,
-	// and a bonus influenced by fearlessness
-	int moving_distance = agility + number + agility * (fearlessness * 0.01);
-	current_distance += moving_distance;
+	return act(getRandomProbability());
+}
+
+// Movement distance is based on agility, player number,
+// and a bonus influenced by fearlessness
+constexpr AttributeTable<uint8_t> PlayerRLGL::distanceBonuses(PlayerRLGL::distanceBonus);
+
+// Same as act(), with the fall-down roll drawn by the caller
+// so a whole turn can share one bulk draw
+bool PlayerRLGL::act(float fallRoll)
+{
+	current_distance += movingDistance(number, agility, fearlessness);
 	
 	// If the player reaches the target distance, they escape successfully
 	if (current_distance >= RedLightGreenLight::distance)
 	{
 		playing = false;  // Player escapes and is no longer active in this game
-		std::cout << "Player #" << number << " escaped! (distance: " << current_distance << ")" << std::endl;
+		TextOut::standard() << "Player #" << number << " escaped! (distance: " << current_distance << ")" << '\n';
 		return true;
 	}
 	
 	// Even if not escaped, the player may fall down with a fixed probability
-	if (possibility(random_engine) < fallDownRate)
+	if (fallRoll < fallDownRate)
 	{
 		playing = false; // Player falls and is eliminated
 		return false;
@@ -60,21 +66,37 @@ bool PlayerRLGL::act()
 
 
 
+// Light phases: the player crossed the line with the given distance walked
+void PlayerRLGL::escape(unsigned int distance)
+{
+	current_distance = distance;
+	playing = false;
+	TextOut::standard() << "Player #" << number << " escaped! (distance: " << current_distance << ")" << '\n';
+}
+
 void PlayerRLGL::dyingMessage()
 { 
+	// Light phases: the doll saw the player still walking
+	if (caught)
+	{
+		printStatus();
+		TextOut::standard() << " was caught moving on red and died." << '\n';
+		return;
+	}
+
 	// If the player is still marked as playing,
 	// they failed to escape before the game ended
 	if (isPlaying())
 	{
 		printStatus();
-		std::cout << " is still on the ground and died." << std::endl;
+		TextOut::standard() << " is still on the ground and died." << '\n';
 	}
 		
 	// Otherwise, the player fell down during movement
 	else
 	{
 		printStatus();
-		std::cout << " fell down and died." << std::endl;
+		TextOut::standard() << " fell down and died." << '\n';
 	}
 };
 
@@ -82,32 +104,21 @@ void PlayerRLGL::dyingMessage()
 
 
 
-bool PlayerRPS::act()
+// Maps a uniform probability to one of the three choices with equal probability
+PlayerRPS::rpsType PlayerRPS::choose(float p)
 {
-	// Enumeration for Rock-Paper-Scissors choices
-	enum rpsType { Rock, Paper, Scissors };
-
-	// Randomly generates one of the three choices with equal probability
-	auto rps = [] {
-		float p = possibility(random_engine);
-
-		if (p < float(1.f / 3.f))
-			return rpsType::Rock;
-		else if (p < float(2.f / 3.f))
-			return rpsType::Paper;
-		else
-			return  rpsType::Scissors;
-	};
+	if (p < float(1.f / 3.f))
+		return rpsType::Rock;
+	else if (p < float(2.f / 3.f))
+		return rpsType::Paper;
+	else
+		return  rpsType::Scissors;
+}
 
-	// Repeat until the result is not a tie
-	rpsType myRPS, yourRPS;
-	do {
-		myRPS = rps();
-		yourRPS = rps();
-	}
-	while(myRPS == yourRPS);
-	
-	// Standard Rock-Paper-Scissors rules
+// Standard Rock-Paper-Scissors rules
+// Returns false only when yourRPS beats myRPS
+bool PlayerRPS::beats(rpsType myRPS, rpsType yourRPS)
+{
 	if (myRPS == Rock)
 	{
 		if (yourRPS == Paper)
@@ -131,11 +142,24 @@ bool PlayerRPS::act()
 	}
 }
 
+bool PlayerRPS::act()
+{
+	// Repeat until the result is not a tie
+	rpsType myRPS, yourRPS;
+	do {
+		myRPS = choose(getRandomProbability());
+		yourRPS = choose(getRandomProbability());
+	}
+	while(myRPS == yourRPS);
+	
+	return beats(myRPS, yourRPS);
+}
+
 
 void PlayerRPS::dyingMessage()
 {
 	printStatus();
-	std::cout << " died." << std::endl;
+	TextOut::standard() << " died." << '\n';
 };
 
 
@@ -150,7 +174,7 @@ bool PlayerTOW::act()
 void PlayerTOW::dyingMessage()
 {
 	printStatus();
-	std::cout << " fell into the water and died." << std::endl;
+	TextOut::standard() << " fell into the water and died." << '\n';
 }
 // Glass Bridge elimination is handled entirely in Game::play()
 bool PlayerGlassBridge::act(){
@@ -161,7 +185,7 @@ bool PlayerGlassBridge::act(){
 void PlayerGlassBridge::dyingMessage(){
 
 	printStatus();
-	std::cout << " fell into the water and died." << std::endl;
+	TextOut::standard() << " fell into the water and died." << '\n';
 }
 
 // Marble game logic is resolved by pair matching in Game::play()
@@ -173,7 +197,7 @@ bool PlayerMarble::act(){
 void PlayerMarble::dyingMessage(){
 
 	printStatus();
-	std::cout << " lost at marbles and died." << std::endl;
+	TextOut::standard() << " lost at marbles and died." << '\n';
 }
 
 // Ddakji outcome is decided based on power comparison in Game::play()
@@ -183,80 +207,84 @@ bool PlayerDdakji::act(){
 
 void PlayerDdakji::dyingMessage(){
 	printStatus();
-	std::cout << " lose at Ddakji." << std::endl;
+	TextOut::standard() << " lose at Ddakji." << '\n';
 }
 
 
 float PlayerShip::doTask() {
 
-    // Base task completion time
-    float baseTime = 8.0f;
-
-    // Ability factor reduces time based on agility and fearlessness
-    float abilityFactor =
-        (getAgility() * 0.6f + getFearlessness() * 0.4f) / 150.0f;
-
     // Random noise to prevent deterministic outcomes
     float randomFactor = Player::getRandomProbability();
 
-    // Final task time calculation
-    // Faster players (high ability) tend to finish earlier,
-    // but randomness still plays a role
-    float taskTime =
-        baseTime
-        * (1.1f - abilityFactor)
-        * (0.85f + randomFactor * 0.3f);
+    float time = taskTime(getAgility(), getFearlessness(), randomFactor);
 
-    std::cout << "Player #" << getNumber()
-              << " task time: " << taskTime << "s" << std::endl;
+    TextOut::standard() << "Player #" << getNumber()
+              << " task time: " << time << "s" << '\n';
 
-    return taskTime;
+    return time;
 }
 
+// Ability factor reduces time based on agility and fearlessness
+constexpr AttributeTable<float> PlayerShip::taskScales(PlayerShip::taskScale);
+
 
 
 void PlayerShip::dyingMessage(){
 	printStatus();
-	std::cout << " lose at Ship." << std::endl;
+	TextOut::standard() << " lose at Ship." << '\n';
 }
 
 bool PlayerSquidGame :: act(){
 
-	// Randomly choose between attacking or defending
-	bool isAttack = (Player :: getRandomProbability() < 0.5f);
+	// Randomly choose between attacking or defending, then roll for survival
+	float attackRoll = Player :: getRandomProbability();
+	bool survived = act(attackRoll, Player::getRandomProbability());
 
-	// Base success probability
-	float baseProb = 0.4f;
+	actionMessage();
+	return survived;
+}
 
-	// Ability bonus increases success chance
-	float abilityBonus = (getAgility() * 0.5f + getFearlessness() * 0.5f) / 200.0f;
+// Resolves one confrontation from pre-drawn rolls without printing,
+// so SquidGame::actAll() can draw the randomness for a whole round at once
+bool PlayerSquidGame :: act(float attackRoll, float roll){
 
-	float successProb = baseProb + abilityBonus;
+	isAttack = (attackRoll < 0.5f);
+	successProb = successProbability(agility, fearlessness, isAttack);
 
-	// Attacking is riskier, defending is slightly safer
-	if (isAttack) successProb -= 0.1f;
+	// Final random roll to determine survival
+	this->roll = roll;
 
-	else successProb += 0.05f;
+	return roll < successProb;
+}
 
-	// Final random roll to determine survival
-	float roll = Player::getRandomProbability();
+// Ability bonus increases success chance
+constexpr AttributeTable<float> PlayerSquidGame::successProbabilities[2] = {
+	AttributeTable<float>([](unsigned int a, unsigned int f) { return successFormula(a, f, false); }),
+	AttributeTable<float>([](unsigned int a, unsigned int f) { return successFormula(a, f, true); }),
+};
 
-	std::cout << "Player #" << getNumber()
+constexpr AttributeTable<uint32_t> PlayerSquidGame::successThresholds[2] = {
+	AttributeTable<uint32_t>([](unsigned int a, unsigned int f) { return RandomBuffer::threshold(successFormula(a, f, false)); }),
+	AttributeTable<uint32_t>([](unsigned int a, unsigned int f) { return RandomBuffer::threshold(successFormula(a, f, true)); }),
+};
+
+// Prints the result of the last act()
+void PlayerSquidGame :: actionMessage(){
+
+	TextOut::standard() << "Player #" << getNumber()
 			<< (isAttack ? " attacks" : " defends")
 			<< " (success prob : " << successProb 
 			<< ", roll : " << roll << ")" ;
 
 	if (roll < successProb){
-		std:: cout << " -> SURVIVED" << std::endl;
-		return true;
+		TextOut::standard() << " -> SURVIVED" << '\n';
 	}else {
-		std::cout << " -> FAILED" <<std::endl;
-		return false;
+		TextOut::standard() << " -> FAILED" <<'\n';
 	}
 }
 
 void PlayerSquidGame::dyingMessage()
 {
     printStatus();
-    std::cout << " was eliminated in the Squid Game." << std::endl;
-}
\ No newline at end of file
+    TextOut::standard() << " was eliminated in the Squid Game." << '\n';
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 ﻿#include <iostream>
-#include <random>
 #include <time.h>
+#include "Random.h"
+#include "TextOut.h"
+#include "AttributeTable.h"
 
 class Player
 {
@@ -10,25 +12,25 @@ public:
 	~Player() {};
 	virtual bool act() { return true; };
 	virtual bool isPlaying() { return playing; };
-	void aliveMessage() { printStatus(); std::cout << " is alive." << std::endl; };
-	virtual void dyingMessage() { printStatus(); std::cout << " died." << std::endl; };
-	virtual void printStatus() { std::cout << "Player #" << number << "(" << agility << "," << fearlessness << ")"; };
+	void aliveMessage() { printStatus(); TextOut::standard() << " is alive." << '\n'; };
+	virtual void dyingMessage() { printStatus(); TextOut::standard() << " died." << '\n'; };
+	virtual void printStatus() { TextOut::standard() << "Player #" << number << "(" << agility << "," << fearlessness << ")"; };
 
 	int getNumber() const { return number; }
 	int getAgility() const { return agility; }
 	int getFearlessness() const { return fearlessness; }
 	int getPower() const { return agility + fearlessness; }
 
-	static float getRandomProbability() { return possibility(random_engine); }
+	static float getRandomProbability() { return random_buffer.nextProbability(); }
+	static void getRandomProbabilities(float* out, size_t count) { random_buffer.fillProbabilities(out, count); }
+	static RandomBuffer& getRandomBuffer() { return random_buffer; }
 	
 protected:
 	unsigned int number;
 	unsigned int agility;
 	unsigned int fearlessness;
 	bool playing = true;
-	static std::default_random_engine random_engine;
-	static std::uniform_int_distribution<unsigned int> ability_range;
-	static std::uniform_real_distribution<float> possibility;
+	static RandomBuffer random_buffer;
 };
 
 
@@ -37,17 +39,40 @@ class PlayerRLGL : public Player
 {
 	static float fallDownRate;
 	unsigned int current_distance = 0;
+	bool caught = false;
 public:
 	PlayerRLGL(const Player& player) : Player(player) { playing = true; };
 	bool act();
+	bool act(float fallRoll);
+	void escape(unsigned int distance);
+	void setCaught() { caught = true; };
+	static unsigned int movingDistance(unsigned int number, unsigned int agility, unsigned int fearlessness)
+	{
+		return number + agility + distanceBonuses(agility, fearlessness);
+	}
 	void dyingMessage();
+
+	// Fearlessness bonus of movingDistance(): agility * fearlessness%,
+	// truncated the way agility + number + agility * (fearlessness * 0.01)
+	// truncates in double, which is the same for every number from 1 until
+	// that int result overflows.
+	static constexpr unsigned int distanceBonus(unsigned int agility, unsigned int fearlessness)
+	{
+		return unsigned(int(agility + 1 + agility * (fearlessness * 0.01))) - agility - 1;
+	}
+	static const AttributeTable<uint8_t> distanceBonuses;
 };
 
 class PlayerRPS : public Player
 {
 public:
+	// Enumeration for Rock-Paper-Scissors choices
+	enum rpsType { Rock, Paper, Scissors };
+
 	PlayerRPS(const Player& player) : Player(player) {  };
 	bool act();
+	static rpsType choose(float p);
+	static bool beats(rpsType myRPS, rpsType yourRPS);
 	void dyingMessage();
 };
 
@@ -91,13 +116,51 @@ class PlayerShip : public Player{
 	public : 
 		PlayerShip(const Player & player) : Player(player) {} ;
 		float doTask();  
+		// Faster players (high ability) tend to finish earlier,
+		// but randomness still plays a role
+		static float taskTime(unsigned int agility, unsigned int fearlessness, float randomFactor)
+		{
+			return taskScales(agility, fearlessness) * (0.85f + randomFactor * 0.3f);
+		}
 		void dyingMessage();
+
+		// Base task time of 8s, reduced by the ability factor
+		static constexpr float taskScale(unsigned int agility, unsigned int fearlessness)
+		{
+			return 8.0f * (1.1f - (int(agility) * 0.6f + int(fearlessness) * 0.4f) / 150.0f);
+		}
+		static const AttributeTable<float> taskScales;
 };
 
 class PlayerSquidGame  : public Player{
 
+	// Outcome of the last act(), kept for actionMessage()
+	bool isAttack = false;
+	float successProb = 0.f;
+	float roll = 0.f;
+
 	public :
 		PlayerSquidGame(const Player & player) : Player(player) {} ;
 		bool act();
+		bool act(float attackRoll, float roll);
+		static float successProbability(unsigned int agility, unsigned int fearlessness, bool isAttack)
+		{
+			return successProbabilities[isAttack](agility, fearlessness);
+		}
+		// RandomBuffer::threshold() of successProbability()
+		static uint32_t successThreshold(unsigned int agility, unsigned int fearlessness, bool isAttack)
+		{
+			return successThresholds[isAttack](agility, fearlessness);
+		}
+		void actionMessage();
+
+		// Base probability 0.4 plus an ability bonus; attacking is riskier,
+		// defending is slightly safer
+		static constexpr float successFormula(unsigned int agility, unsigned int fearlessness, bool isAttack)
+		{
+			return 0.4f + (int(agility) * 0.5f + int(fearlessness) * 0.5f) / 200.0f + (isAttack ? -0.1f : 0.05f);
+		}
+		static const AttributeTable<float> successProbabilities[2];	// defending, attacking
+		static const AttributeTable<uint32_t> successThresholds[2];
 		void dyingMessage();
-};
\ No newline at end of file
+};
\ No newline at end of file
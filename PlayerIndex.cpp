@@ -0,0 +1,107 @@
+#include <iostream>
+#include "PlayerIndex.h"
+#include "Player.h"
+
+void PlayerIndex::refresh(const Population& population)
+{
+	for (size_t i = 0; i < population.size(); ++i)
+	{
+		size_t number = size_t(population[i].getNumber());
+		if (number >= slots.size())
+			slots.resize(number + 1, 0);
+		slots[number] = uint32_t(i);
+	}
+}
+
+
+void PlayerTracker::track(int number)
+{
+	Outcome outcome;
+	outcome.number = number;
+	outcomes.push_back(outcome);
+}
+
+// Slot of number, searched from near down to the front, then above near
+size_t PlayerTracker::scan(const Population& population, int number, size_t near)
+{
+	if (population.empty())
+		return npos;
+
+	size_t from = near < population.size() ? near : population.size() - 1;
+	for (size_t i = from + 1; i-- > 0;)
+	{
+		if (population[i].getNumber() == number)
+			return i;
+	}
+	for (size_t i = from + 1; i < population.size(); ++i)
+	{
+		if (population[i].getNumber() == number)
+			return i;
+	}
+	return npos;
+}
+
+// Starting populations are usually numbered 1..n in order
+void PlayerTracker::start(const Population& population)
+{
+	bool scanning = outcomes.size() <= maxScanned;
+	if (!scanning)
+		index.refresh(population);
+
+	for (auto& outcome : outcomes)
+	{
+		size_t slot = scanning ? scan(population, outcome.number, size_t(outcome.number - 1))
+			: index.find(population, outcome.number);
+		outcome.player = (slot != npos) ? population[slot] : CompactPlayer();
+		outcome.eliminatedIn = npos;
+		outcome.finalSlot = slot;
+	}
+}
+
+void PlayerTracker::afterGame(size_t game, const Population& population)
+{
+	size_t alive = 0;
+	for (auto& outcome : outcomes)
+		alive += outcome.finalSlot != npos;
+
+	bool scanning = alive <= maxScanned;
+	if (!scanning)
+		index.refresh(population);
+
+	for (auto& outcome : outcomes)
+	{
+		if (outcome.finalSlot == npos)
+			continue;
+
+		outcome.finalSlot = scanning ? scan(population, outcome.number, outcome.finalSlot)
+			: index.find(population, outcome.number);
+		if (outcome.finalSlot == npos)
+			outcome.eliminatedIn = game;
+	}
+}
+
+void PlayerTracker::printReport(const std::vector<std::string>& gameNames) const
+{
+	std::cout << "\n[Tracked Players]" << std::endl;
+
+	for (auto& outcome : outcomes)
+	{
+		if (outcome.player.getNumber() == 0)
+		{
+			std::cout << "Player #" << outcome.number << ": not in the population" << std::endl;
+			continue;
+		}
+
+		Player(outcome.player.getNumber(), outcome.player.getAgility(), outcome.player.getFearlessness()).printStatus();
+		TextOut::standard().flush();
+		if (outcome.eliminatedIn == npos)
+			std::cout << ": survived every game" << std::endl;
+		else
+		{
+			std::cout << ": eliminated in " << gameNames[outcome.eliminatedIn];
+			if (outcome.eliminatedIn > 0)
+				std::cout << " after surviving " << gameNames[outcome.eliminatedIn - 1];
+			std::cout << std::endl;
+		}
+	}
+}
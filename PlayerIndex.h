@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CompactPlayer.h"
+
+// Maps player numbers to their slot in a Population in O(1).
+// refresh() after a game rewrites the entries of the survivors only.
+// An eliminated player's old entry is left behind, but it points past the
+// end or at a slot now holding someone else, so find() reports it missing.
+class PlayerIndex
+{
+	std::vector<uint32_t> slots;
+public:
+	static const size_t npos = size_t(-1);
+
+	void refresh(const Population& population);
+
+	// Slot of number in population, npos if it is not there
+	size_t find(const Population& population, int number) const
+	{
+		if (number <= 0 || size_t(number) >= slots.size())
+			return npos;
+
+		size_t slot = slots[number];
+		if (slot < population.size() && population[slot].getNumber() == number)
+			return slot;
+		return npos;
+	}
+};
+
+// Follows chosen players through a tournament.
+// A few followed players are looked for from their last slot: games keep
+// survivors in order almost always, so a survivor is found scanning down
+// from there and only a death or a reordering game costs a full pass.
+// Beyond maxScanned followed players, one index refresh per game and a
+// lookup per player is cheaper.
+class PlayerTracker
+{
+public:
+	struct Outcome
+	{
+		int number = 0;
+		CompactPlayer player;			// attributes at the start, number 0 if not in the population
+		size_t eliminatedIn = npos;		// game index, npos while alive
+		size_t finalSlot = npos;		// slot after the last game, npos if eliminated
+	};
+
+	static const size_t npos = PlayerIndex::npos;
+
+	void track(int number);
+	bool isEmpty() const { return outcomes.empty(); }
+
+	// Call with the starting population, then after every game
+	void start(const Population& population);
+	void afterGame(size_t game, const Population& population);
+
+	const std::vector<Outcome>& getOutcomes() const { return outcomes; }
+	void printReport(const std::vector<std::string>& gameNames) const;
+
+private:
+	static const size_t maxScanned = 8;
+
+	PlayerIndex index;
+	std::vector<Outcome> outcomes;
+
+	static size_t scan(const Population& population, int number, size_t near);
+};
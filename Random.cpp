@@ -0,0 +1,131 @@
+#include "Random.h"
+#include "Metrics.h"
+
+// SplitMix64, used only to expand a seed into lane states
+static uint64_t splitMix64(uint64_t& x)
+{
+	uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+static inline uint32_t rotl(uint32_t x, int k)
+{
+	return (x << k) | (x >> (32 - k));
+}
+
+// Seeds every lane from one 64-bit seed and drops the buffered draws
+void RandomBuffer::reseed(uint64_t seed)
+{
+	for (size_t lane = 0; lane < lanes; ++lane)
+	{
+		uint64_t a = splitMix64(seed);
+		uint64_t b = splitMix64(seed);
+		state[0][lane] = uint32_t(a);
+		state[1][lane] = uint32_t(a >> 32);
+		state[2][lane] = uint32_t(b);
+		state[3][lane] = uint32_t(b >> 32) | 1; // never all zero
+	}
+	cursor = capacity;
+}
+
+// Regenerates the whole buffer.
+// Lane l writes words[i + l], so the inner loop is a plain 8-wide vector step.
+void RandomBuffer::refill()
+{
+	uint32_t s0[lanes], s1[lanes], s2[lanes], s3[lanes];
+	for (size_t lane = 0; lane < lanes; ++lane)
+	{
+		s0[lane] = state[0][lane];
+		s1[lane] = state[1][lane];
+		s2[lane] = state[2][lane];
+		s3[lane] = state[3][lane];
+	}
+
+	for (size_t i = 0; i < capacity; i += lanes)
+	{
+		for (size_t lane = 0; lane < lanes; ++lane)
+		{
+			words[i + lane] = rotl(s1[lane] * 5, 7) * 9;
+
+			uint32_t t = s1[lane] << 9;
+			s2[lane] ^= s0[lane];
+			s3[lane] ^= s1[lane];
+			s1[lane] ^= s2[lane];
+			s0[lane] ^= s3[lane];
+			s2[lane] ^= t;
+			s3[lane] = rotl(s3[lane], 11);
+		}
+	}
+
+	for (size_t lane = 0; lane < lanes; ++lane)
+	{
+		state[0][lane] = s0[lane];
+		state[1][lane] = s1[lane];
+		state[2][lane] = s2[lane];
+		state[3][lane] = s3[lane];
+	}
+	cursor = 0;
+
+	if (Metrics::isEnabled())
+		Metrics::local().addRandomWords(capacity);
+}
+
+// Lemire's multiply-shift with rejection, so every value is equally likely
+unsigned int RandomBuffer::nextBelow(unsigned int bound)
+{
+	uint64_t m = uint64_t(nextWord()) * bound;
+	uint32_t low = uint32_t(m);
+
+	if (low < bound)
+	{
+		uint32_t threshold = uint32_t(-bound) % bound;
+		while (low < threshold)
+		{
+			m = uint64_t(nextWord()) * bound;
+			low = uint32_t(m);
+		}
+	}
+	return static_cast<unsigned int>(m >> 32);
+}
+
+void RandomBuffer::fillWords(uint32_t* out, size_t count)
+{
+	while (count > 0)
+	{
+		if (cursor == capacity)
+			refill();
+
+		size_t n = capacity - cursor;
+		if (n > count)
+			n = count;
+
+		for (size_t i = 0; i < n; ++i)
+			out[i] = words[cursor + i];
+
+		cursor += n;
+		out += n;
+		count -= n;
+	}
+}
+
+void RandomBuffer::fillProbabilities(float* out, size_t count)
+{
+	while (count > 0)
+	{
+		if (cursor == capacity)
+			refill();
+
+		size_t n = capacity - cursor;
+		if (n > count)
+			n = count;
+
+		for (size_t i = 0; i < n; ++i)
+			out[i] = toProbability(words[cursor + i]);
+
+		cursor += n;
+		out += n;
+		count -= n;
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Buffered random number service.
+// Eight independent xoshiro128** lanes are stepped side by side so the
+// refill loop vectorizes, and draws are served from the buffer with a cursor.
+class RandomBuffer
+{
+public:
+	static const size_t lanes = 8;
+	static const size_t capacity = 4096;
+
+	RandomBuffer(uint64_t seed) { reseed(seed); };
+	void reseed(uint64_t seed);
+
+	// Raw 32-bit draw
+	uint32_t nextWord()
+	{
+		if (cursor == capacity)
+			refill();
+		return words[cursor++];
+	}
+
+	// Uniform probability in [0, 1)
+	float nextProbability() { return toProbability(nextWord()); }
+
+	// Uniform integer in [0, bound)
+	unsigned int nextBelow(unsigned int bound);
+
+	void fillWords(uint32_t* out, size_t count);
+	void fillProbabilities(float* out, size_t count);
+
+	// Top 24 bits scaled to [0, 1), exact in float
+	static float toProbability(uint32_t word) { return (word >> 8) * (1.0f / 16777216.0f); }
+
+	// Integer form of a probability: toProbability(word) < p exactly when
+	// (word >> 8) < threshold(p), so a fixed probability is compared without floats
+	static constexpr uint32_t threshold(float p)
+	{
+		return p <= 0.0f ? 0
+			: p >= 1.0f ? 1u << 24
+			: uint32_t(p * 16777216.0f) + (float(uint32_t(p * 16777216.0f)) < p * 16777216.0f ? 1 : 0);
+	}
+
+	// nextProbability() < p for p with the given threshold
+	bool nextChance(uint32_t threshold) { return (nextWord() >> 8) < threshold; }
+
+private:
+	void refill();
+
+	alignas(64) uint32_t state[4][lanes];
+	alignas(64) uint32_t words[capacity];
+	size_t cursor = capacity;
+};
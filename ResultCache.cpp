@@ -0,0 +1,187 @@
+#include <cstdio>
+#include <cstring>
+#include "ResultCache.h"
+#include "Game.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RESULT_CACHE_MMAP
+#endif
+
+namespace
+{
+	const char magic[8] = { 'S', 'Q', 'C', 'A', 'C', 'H', 'E', '1' };
+
+	struct FileHeader
+	{
+		char magic[8];
+		uint64_t key;
+	};
+
+	// Followed by size bytes of payload
+	struct EntryHeader
+	{
+		uint64_t first;
+		uint64_t runs;
+		uint64_t size;
+		uint64_t checksum;
+	};
+
+	uint64_t checksum(const EntryHeader& entry, const void* data)
+	{
+		CacheKey sum;
+		sum.add(entry.first);
+		sum.add(entry.runs);
+		sum.add(entry.size);
+		sum.add(data, size_t(entry.size));
+		return sum.get();
+	}
+}
+
+void CacheKey::add(const void* data, size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+}
+
+uint64_t ResultCache::makeKey(const std::vector<const Game*>& games, const Population& population, uint64_t seed)
+{
+	CacheKey key;
+	key.add(uint64_t(rulesVersion));
+	key.add(uint64_t(games.size()));
+	for (auto game : games)
+	{
+		key.add(game->getName());
+		key.add(game->getParameters());
+	}
+
+	// The players themselves, not how they were made, so every source of
+	// the same population shares results
+	key.add(uint64_t(population.size()));
+	for (auto& player : population)
+	{
+		uint32_t fields[3] = { uint32_t(player.getNumber()), uint32_t(player.getAgility()), uint32_t(player.getFearlessness()) };
+		key.add(fields, sizeof(fields));
+	}
+
+	key.add(seed);
+	return key.get();
+}
+
+ResultCache::ResultCache(const std::string& directory, uint64_t key)
+	: key(key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.cache", (unsigned long long)key);
+	path = directory.empty() ? name : directory + "/" + name;
+
+#ifdef RESULT_CACHE_MMAP
+	if (!directory.empty())
+		mkdir(directory.c_str(), 0755);
+
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return;
+
+	struct stat info;
+	if (fstat(file, &info) == 0 && info.st_size > 0)
+	{
+		void* data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		if (data != MAP_FAILED)
+		{
+			mapped = static_cast<const char*>(data);
+			mappedSize = size_t(info.st_size);
+		}
+	}
+	close(file);
+
+	if (mapped)
+		scan(mapped, mappedSize);
+#else
+	FILE* file = fopen(path.c_str(), "rb");
+	if (!file)
+		return;
+
+	char buffer[1 << 16];
+	size_t count;
+	while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		loaded.insert(loaded.end(), buffer, buffer + count);
+	fclose(file);
+
+	scan(loaded.data(), loaded.size());
+#endif
+}
+
+ResultCache::~ResultCache()
+{
+#ifdef RESULT_CACHE_MMAP
+	if (mapped)
+		munmap(const_cast<char*>(mapped), mappedSize);
+#endif
+}
+
+// Indexes every whole entry of a file with the right header
+void ResultCache::scan(const char* data, size_t size)
+{
+	FileHeader header;
+	if (size < sizeof(header))
+		return;
+	memcpy(&header, data, sizeof(header));
+	if (memcmp(header.magic, magic, sizeof(magic)) != 0 || header.key != key)
+		return;
+
+	size_t offset = sizeof(header);
+	while (size - offset >= sizeof(EntryHeader))
+	{
+		EntryHeader entry;
+		memcpy(&entry, data + offset, sizeof(entry));
+		offset += sizeof(entry);
+
+		if (entry.size > size - offset || checksum(entry, data + offset) != entry.checksum)
+			break;
+
+		index[{ entry.first, entry.runs }] = { data + offset, size_t(entry.size) };
+		offset += size_t(entry.size);
+	}
+}
+
+const void* ResultCache::find(uint64_t first, uint64_t runs, size_t size) const
+{
+	auto found = index.find({ first, runs });
+	if (found == index.end() || found->second.second != size)
+		return nullptr;
+	return found->second.first;
+}
+
+// Header and payload are appended together; an entry cut short fails its checksum
+bool ResultCache::store(uint64_t first, uint64_t runs, const void* data, size_t size)
+{
+	FILE* file = fopen(path.c_str(), "ab");
+	if (!file)
+		return false;
+
+	std::vector<char> buffer;
+	fseek(file, 0, SEEK_END);
+	if (ftell(file) == 0)
+	{
+		FileHeader header;
+		memcpy(header.magic, magic, sizeof(magic));
+		header.key = key;
+		buffer.insert(buffer.end(), reinterpret_cast<const char*>(&header), reinterpret_cast<const char*>(&header) + sizeof(header));
+	}
+
+	EntryHeader entry = { first, runs, uint64_t(size), 0 };
+	entry.checksum = checksum(entry, data);
+	buffer.insert(buffer.end(), reinterpret_cast<const char*>(&entry), reinterpret_cast<const char*>(&entry) + sizeof(entry));
+	buffer.insert(buffer.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+
+	bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+	return fclose(file) == 0 && written;
+}
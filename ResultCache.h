@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "CompactPlayer.h"
+
+class Game;
+
+// 64-bit FNV-1a over everything that decides a campaign's results
+class CacheKey
+{
+	uint64_t hash = 14695981039346656037ull;
+public:
+	void add(const void* data, size_t size);
+	void add(uint64_t value) { add(&value, sizeof(value)); }
+	void add(const std::string& text) { add(uint64_t(text.size())); add(text.data(), text.size()); }
+	uint64_t get() const { return hash; }
+};
+
+// On-disk results of finished runs, shared between invocations.
+// A campaign's file is named by the hash of its games in order with every
+// parameter, its starting population and its base seed, so any change to
+// those starts a new file. The file holds one entry per range of runs,
+// each an opaque payload with a checksum, appended as ranges finish. It is
+// memory-mapped on open; entries cut short by a crash or a concurrent
+// writer fail their checksum and end the scan.
+class ResultCache
+{
+	std::string path;
+	uint64_t key;
+	const char* mapped = nullptr;
+	size_t mappedSize = 0;
+	std::vector<char> loaded;		// used where files cannot be mapped
+	std::map<std::pair<uint64_t, uint64_t>, std::pair<const char*, size_t>> index;	// (first, runs) -> payload
+
+	void scan(const char* data, size_t size);
+public:
+	// Change when the rules or the random draws of any game change,
+	// so stale files are never read
+	static const uint32_t rulesVersion = 1;
+
+	static uint64_t makeKey(const std::vector<const Game*>& games, const Population& population, uint64_t seed);
+
+	// Opens (and later creates) the campaign's file in directory
+	ResultCache(const std::string& directory, uint64_t key);
+	~ResultCache();
+
+	ResultCache(const ResultCache&) = delete;
+	ResultCache& operator=(const ResultCache&) = delete;
+
+	// Payload of runs [first, first + runs) if it was stored with this size, else null
+	const void* find(uint64_t first, uint64_t runs, size_t size) const;
+
+	// Appends the payload of runs [first, first + runs); false if the file cannot be written
+	bool store(uint64_t first, uint64_t runs, const void* data, size_t size);
+
+	const std::string& getPath() const { return path; }
+	size_t getEntryCount() const { return index.size(); }
+};
@@ -0,0 +1,222 @@
+#include "Scheduler.h"
+#include "Numa.h"
+
+thread_local TaskScheduler* TaskScheduler::current = nullptr;
+thread_local size_t TaskScheduler::currentIndex = 0;
+thread_local size_t TaskScheduler::taskDepth = 0;
+
+TaskScheduler::TaskScheduler(unsigned int threads, bool pinned)
+{
+	const NumaTopology& topology = NumaTopology::system();
+	std::vector<int> cpus = topology.getCpuOrder();
+
+	if (threads == 0)
+		threads = pinned ? unsigned(cpus.size()) : std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	for (unsigned int i = 0; i < threads; ++i)
+		queues.emplace_back(new Queue());
+
+	// The outside caller's slot is never pinned
+	slotNodes.assign(threads, -1);
+	if (pinned)
+	{
+		for (unsigned int i = 0; i + 1 < threads; ++i)
+			slotNodes[i] = topology.getNodeOfCpu(cpus[i % cpus.size()]);
+	}
+
+	// Own deque first, then the same node, then everyone else in ring order
+	victims.resize(threads);
+	for (unsigned int self = 0; self < threads; ++self)
+	{
+		victims[self].push_back(self);
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			for (unsigned int k = 1; k < threads; ++k)
+			{
+				size_t victim = (self + k) % threads;
+				bool near = slotNodes[self] < 0 || slotNodes[victim] == slotNodes[self];
+				if (near == (pass == 0))
+					victims[self].push_back(victim);
+			}
+		}
+	}
+
+	if (pinned)
+	{
+		for (unsigned int i = 0; i + 1 < threads; ++i)
+		{
+			int cpu = cpus[i % cpus.size()];
+			this->threads.emplace_back([this, i, cpu] {
+				pinCurrentThread(cpu);
+				NodeArena::setCurrentNode(slotNodes[i]);
+				workerLoop(i);
+			});
+		}
+		return;
+	}
+
+	for (unsigned int i = 0; i + 1 < threads; ++i)
+		this->threads.emplace_back(&TaskScheduler::workerLoop, this, i);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& thread : threads)
+		thread.join();
+}
+
+TaskScheduler& TaskScheduler::shared()
+{
+	static TaskScheduler scheduler;
+	return scheduler;
+}
+
+void TaskScheduler::spawn(TaskGroup& group, std::function<void()> task)
+{
+	group.pending++;
+
+	// queued only changes under the lock of the deque that holds the job,
+	// counted before the job is visible, so a thief never takes it below zero
+	Queue& queue = *queues[currentSlot()];
+	{
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queued++;
+		queue.jobs.push_back({ std::move(task), &group });
+	}
+
+	// A sleeper counts itself before checking queued, so either it sees
+	// this job or we see it and wake it under the lock it sleeps with
+	if (sleepers.load() > 0)
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		wake.notify_one();
+	}
+}
+
+// Runs one job: the newest from our own deque, otherwise the oldest of another's.
+// With only set, just jobs of that group are taken.
+bool TaskScheduler::runOne(size_t self, const TaskGroup* only)
+{
+	Job job;
+	bool found = false;
+
+	for (size_t k = 0; k < queues.size() && !found; ++k)
+	{
+		size_t victim = victims[self][k];
+		Queue& queue = *queues[victim];
+
+		std::lock_guard<std::mutex> guard(queue.lock);
+		if (queue.jobs.empty())
+			continue;
+
+		if (only == nullptr)
+		{
+			auto position = (k == 0) ? queue.jobs.end() - 1 : queue.jobs.begin();
+			job = std::move(*position);
+			queue.jobs.erase(position);
+			queued--;
+			found = true;
+		}
+		else
+		{
+			for (auto position = queue.jobs.begin(); position != queue.jobs.end(); ++position)
+			{
+				if (position->group == only)
+				{
+					job = std::move(*position);
+					queue.jobs.erase(position);
+					queued--;
+					found = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (!found)
+		return false;
+
+	taskDepth++;
+	job.run();
+	taskDepth--;
+
+	// The group may be gone as soon as pending reaches zero
+	if (--job.group->pending == 0)
+	{
+		std::lock_guard<std::mutex> guard(sleepLock);
+		wake.notify_all();
+		finished.notify_all();
+	}
+	return true;
+}
+
+void TaskScheduler::workerLoop(size_t index)
+{
+	current = this;
+	currentIndex = index;
+
+	while (!stopping)
+	{
+		if (runOne(index, nullptr))
+			continue;
+
+		std::unique_lock<std::mutex> guard(sleepLock);
+		sleepers++;
+		wake.wait(guard, [this] { return queued > 0 || stopping; });
+		sleepers--;
+	}
+}
+
+// The waiting thread helps with queued work until its group is finished.
+// Inside a task it can only take its own group's jobs; once none are left
+// queued the rest are running elsewhere, so it sleeps until they end.
+void TaskScheduler::wait(TaskGroup& group)
+{
+	size_t self = currentSlot();
+	const TaskGroup* only = taskDepth > 0 ? &group : nullptr;
+
+	while (!group.isDone())
+	{
+		if (runOne(self, only))
+			continue;
+
+		std::unique_lock<std::mutex> guard(sleepLock);
+		if (only)
+			finished.wait(guard, [&group] { return group.isDone(); });
+		else
+		{
+			sleepers++;
+			wake.wait(guard, [this, &group] { return group.isDone() || queued > 0; });
+			sleepers--;
+		}
+	}
+}
+
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body)
+{
+	if (grain == 0)
+		grain = 1;
+
+	if (end - begin <= grain)
+	{
+		if (begin < end)
+			body(begin, end);
+		return;
+	}
+
+	TaskGroup group;
+	for (size_t first = begin; first < end; first += grain)
+	{
+		size_t last = first + grain < end ? first + grain : end;
+		spawn(group, [&body, first, last] { body(first, last); });
+	}
+	wait(group);
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the tasks spawned for one wait()
+class TaskGroup
+{
+	std::atomic<size_t> pending{ 0 };
+	friend class TaskScheduler;
+public:
+	bool isDone() const { return pending.load() == 0; }
+};
+
+// Work-stealing task pool.
+// Each participant has its own deque: the owner pushes and pops at the back,
+// idle participants steal from the front of the others. A thread waiting on a
+// group keeps running tasks instead of blocking, so nested parallel loops
+// reuse the same threads rather than oversubscribing the machine.
+// A wait inside a task only helps with that group's own tasks, so per-slot
+// state of the outer task is never re-entered.
+//
+// Slots 0..n-2 are pool threads; slot n-1 is for one outside caller at a
+// time, which takes part in the work while it waits.
+//
+// A pinned pool binds each worker to one CPU, filling NUMA nodes in order,
+// and steals from workers on its own node before crossing to another one.
+// Buffers a worker allocates through NodeAllocator then stay on its node.
+class TaskScheduler
+{
+	struct Job
+	{
+		std::function<void()> run;
+		TaskGroup* group;
+	};
+
+	struct Queue
+	{
+		std::mutex lock;
+		std::deque<Job> jobs;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> threads;
+
+	// Per slot: the order in which the other deques are searched
+	std::vector<std::vector<size_t>> victims;
+	std::vector<int> slotNodes;
+
+	// Idle participants sleep on wake until a spawn or the end of a group;
+	// a wait inside a task, which can only take its own group's jobs,
+	// sleeps on finished until its group is done
+	std::mutex sleepLock;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	std::atomic<size_t> sleepers{ 0 };
+	std::atomic<size_t> queued{ 0 };
+	std::atomic<bool> stopping{ false };
+
+	static thread_local TaskScheduler* current;
+	static thread_local size_t currentIndex;
+	static thread_local size_t taskDepth;
+
+	bool runOne(size_t self, const TaskGroup* only);
+	void workerLoop(size_t index);
+public:
+	// threads counts every participant, including the caller; 0 = hardware concurrency
+	explicit TaskScheduler(unsigned int threads = 0, bool pinned = false);
+	~TaskScheduler();
+
+	// Pool used by the simulation drivers when none is given, started on first use
+	static TaskScheduler& shared();
+
+	size_t getConcurrency() const { return queues.size(); }
+
+	// Tasks spawned but not yet taken by any participant
+	size_t getQueuedTasks() const { return queued.load(std::memory_order_relaxed); }
+
+	// NUMA node of a slot, -1 when the pool is not pinned
+	int getSlotNode(size_t slot) const { return slotNodes[slot]; }
+
+	// Slot of the calling thread, in [0, getConcurrency())
+	size_t currentSlot() const { return current == this ? currentIndex : queues.size() - 1; }
+
+	void spawn(TaskGroup& group, std::function<void()> task);
+	void wait(TaskGroup& group);
+
+	// Calls body(first, last) on chunks of at most grain indices and waits for all of them
+	void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body);
+};
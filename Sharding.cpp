@@ -0,0 +1,303 @@
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include "Sharding.h"
+#include "Game.h"
+#include "Tournament.h"
+#include "ResultCache.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SHARDING_PROCESSES 1
+#endif
+
+namespace
+{
+	// Start of the shared segment
+	struct SegmentHeader
+	{
+		std::atomic<uint64_t> nextShard;
+		char padding[56];
+	};
+
+	enum ShardState : uint32_t
+	{
+		Unclaimed = 0,
+		Claimed = 1,
+		Done = 2
+	};
+
+	// Start of one shard's slot; followed by the per-game totals and the
+	// winner of every run of every game
+	struct SlotHeader
+	{
+		std::atomic<uint32_t> state;
+		uint32_t worker;
+		uint64_t runs;
+	};
+
+	struct GameTotals
+	{
+		uint64_t initial;
+		uint64_t survivors;
+		uint64_t deaths;
+	};
+}
+
+ShardedRunner::ShardedRunner(const std::vector<const Game*>& games, const Population& population, uint64_t seed)
+	: games(games), population(population), seed(seed)
+{
+	initial.assign(games.size(), 0);
+	survivors.assign(games.size(), 0);
+	deaths.assign(games.size(), 0);
+	wins.resize(games.size());
+}
+
+size_t ShardedRunner::slotSize(size_t shardRuns) const
+{
+	size_t size = sizeof(SlotHeader) + games.size() * sizeof(GameTotals) + shardRuns * games.size() * sizeof(CompactPlayer);
+	return (size + 63) & ~size_t(63);
+}
+
+// Bytes of a finished shard after its header: the totals, then the winners of its runs
+size_t ShardedRunner::payloadSize(uint64_t runs) const
+{
+	return games.size() * sizeof(GameTotals) + size_t(runs) * games.size() * sizeof(CompactPlayer);
+}
+
+// Copies the shards the cache holds into their slots and marks them Done
+// before any worker starts, so workers skip them
+void ShardedRunner::loadCached(void* segment, size_t shardCount, size_t shardRuns, uint64_t totalRuns, const ResultCache& cache, std::vector<bool>& cached)
+{
+	char* slots = static_cast<char*>(segment) + sizeof(SegmentHeader);
+	for (size_t shard = 0; shard < shardCount; ++shard)
+	{
+		uint64_t first = uint64_t(shard) * shardRuns;
+		uint64_t runs = first + shardRuns < totalRuns ? shardRuns : totalRuns - first;
+		const void* payload = cache.find(first, runs, payloadSize(runs));
+		if (!payload)
+			continue;
+
+		char* slot = slots + shard * slotSize(shardRuns);
+		SlotHeader& slotHeader = *reinterpret_cast<SlotHeader*>(slot);
+		memcpy(slot + sizeof(SlotHeader), payload, payloadSize(runs));
+		slotHeader.runs = runs;
+		slotHeader.state.store(Done, std::memory_order_release);
+		cached[shard] = true;
+		cachedShards++;
+	}
+}
+
+// Worker body: claims shards until none are left.
+// A slot is only marked Done after all of its data is written.
+void ShardedRunner::playShards(void* segment, size_t shardCount, size_t shardRuns, uint64_t totalRuns)
+{
+	SegmentHeader& header = *static_cast<SegmentHeader*>(segment);
+	char* slots = static_cast<char*>(segment) + sizeof(SegmentHeader);
+	TournamentRunner runner(games);
+
+	for (;;)
+	{
+		uint64_t shard = header.nextShard.fetch_add(1);
+		if (shard >= shardCount)
+			break;
+
+		char* slot = slots + shard * slotSize(shardRuns);
+		SlotHeader& slotHeader = *reinterpret_cast<SlotHeader*>(slot);
+		GameTotals* totals = reinterpret_cast<GameTotals*>(slot + sizeof(SlotHeader));
+		CompactPlayer* shardWinners = reinterpret_cast<CompactPlayer*>(totals + games.size());
+
+		// Read from the cache
+		if (slotHeader.state.load(std::memory_order_acquire) == Done)
+			continue;
+
+#ifdef SHARDING_PROCESSES
+		slotHeader.worker = uint32_t(getpid());
+#endif
+		slotHeader.state.store(Claimed);
+
+		uint64_t first = shard * shardRuns;
+		uint64_t last = first + shardRuns < totalRuns ? first + shardRuns : totalRuns;
+		for (uint64_t r = first; r < last; ++r)
+		{
+			runner.run(population, seed + r);
+
+			const std::vector<GameRecord>& records = runner.getRecords();
+			for (size_t g = 0; g < games.size(); ++g)
+			{
+				totals[g].initial += records[g].initial_count;
+				totals[g].survivors += records[g].survivor_count;
+				totals[g].deaths += records[g].death_count;
+				shardWinners[(r - first) * games.size() + g] = records[g].winner;
+			}
+		}
+
+		slotHeader.runs = last - first;
+		slotHeader.state.store(Done, std::memory_order_release);
+	}
+}
+
+void ShardedRunner::run(unsigned int workers, uint64_t totalRuns, size_t shardRuns, ResultCache* cache)
+{
+	if (workers == 0)
+		workers = 1;
+	if (shardRuns == 0)
+		shardRuns = 1;
+
+	size_t shardCount = size_t((totalRuns + shardRuns - 1) / shardRuns);
+	size_t segmentSize = sizeof(SegmentHeader) + shardCount * slotSize(shardRuns);
+	std::vector<bool> cached(shardCount, false);
+
+#ifdef SHARDING_PROCESSES
+	// Anonymous shared pages are zeroed, so every slot starts Unclaimed
+	void* segment = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (segment == MAP_FAILED)
+	{
+		std::cerr << "Cannot map " << segmentSize << " bytes of shared memory" << std::endl;
+		return;
+	}
+
+	if (cache)
+		loadCached(segment, shardCount, shardRuns, totalRuns, *cache, cached);
+
+	// Children must not flush output the parent has buffered
+	std::cout.flush();
+	std::cerr.flush();
+
+	auto startWorker = [&]() -> bool {
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			playShards(segment, shardCount, shardRuns, totalRuns);
+			_exit(0);
+		}
+		return pid > 0;
+	};
+
+	unsigned int alive = 0;
+	for (unsigned int w = 0; w < workers; ++w)
+	{
+		if (startWorker())
+			alive++;
+	}
+	if (alive == 0)
+		playShards(segment, shardCount, shardRuns, totalRuns);
+
+	// Replace crashed workers while work remains, at most once per original worker
+	unsigned int restarts = 0;
+	SegmentHeader& header = *static_cast<SegmentHeader*>(segment);
+	while (alive > 0)
+	{
+		int status = 0;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0)
+			break;
+		alive--;
+
+		bool crashed = WIFSIGNALED(status) || (WIFEXITED(status) && WEXITSTATUS(status) != 0);
+		if (!crashed)
+			continue;
+
+		if (WIFSIGNALED(status))
+			std::cerr << "Worker " << pid << " killed by signal " << WTERMSIG(status) << std::endl;
+		else
+			std::cerr << "Worker " << pid << " exited with status " << WEXITSTATUS(status) << std::endl;
+
+		if (header.nextShard.load() < shardCount && restarts < workers && startWorker())
+		{
+			alive++;
+			restarts++;
+		}
+	}
+#else
+	std::vector<char> memory(segmentSize, 0);
+	void* segment = memory.data();
+	if (cache)
+		loadCached(segment, shardCount, shardRuns, totalRuns, *cache, cached);
+	playShards(segment, shardCount, shardRuns, totalRuns);
+#endif
+
+	bool cacheFailed = false;
+	char* slots = static_cast<char*>(segment) + sizeof(SegmentHeader);
+	for (size_t shard = 0; shard < shardCount; ++shard)
+	{
+		char* slot = slots + shard * slotSize(shardRuns);
+		SlotHeader& slotHeader = *reinterpret_cast<SlotHeader*>(slot);
+		if (slotHeader.state.load(std::memory_order_acquire) != Done)
+		{
+			lostShards.push_back(shard);
+			continue;
+		}
+
+		GameTotals* totals = reinterpret_cast<GameTotals*>(slot + sizeof(SlotHeader));
+		CompactPlayer* shardWinners = reinterpret_cast<CompactPlayer*>(totals + games.size());
+
+		for (size_t g = 0; g < games.size(); ++g)
+		{
+			initial[g] += totals[g].initial;
+			survivors[g] += totals[g].survivors;
+			deaths[g] += totals[g].deaths;
+		}
+		for (size_t i = 0; i < slotHeader.runs * games.size(); ++i)
+		{
+			const CompactPlayer& winner = shardWinners[i];
+			if (winner.getNumber() == 0)
+				continue;
+			auto& entry = wins[i % games.size()][winner.getNumber()];
+			entry.first++;
+			entry.second = winner;
+		}
+		runs += slotHeader.runs;
+
+		if (cache && !cached[shard] && !cacheFailed)
+		{
+			cacheFailed = !cache->store(uint64_t(shard) * shardRuns, slotHeader.runs, totals, payloadSize(slotHeader.runs));
+			if (cacheFailed)
+				std::cerr << "Cannot write " << cache->getPath() << std::endl;
+		}
+	}
+
+#ifdef SHARDING_PROCESSES
+	munmap(segment, segmentSize);
+#endif
+}
+
+void ShardedRunner::applyTo(const std::vector<Game*>& games) const
+{
+	for (size_t g = 0; g < games.size() && g < this->games.size(); ++g)
+	{
+		CompactPlayer best;
+		uint64_t bestWins = 0;
+		for (auto& entry : wins[g])
+		{
+			if (entry.second.first > bestWins)
+			{
+				bestWins = entry.second.first;
+				best = entry.second.second;
+			}
+		}
+
+		double scale = runs > 0 ? 1.0 / runs : 0.0;
+		games[g]->setSummary(unsigned(std::llround(initial[g] * scale)),
+			unsigned(std::llround(survivors[g] * scale)),
+			unsigned(std::llround(deaths[g] * scale)), best,
+			initial[g] > 0 ? float(100.0 * deaths[g] / initial[g]) : 0.0f);
+	}
+}
+
+void ShardedRunner::printReport() const
+{
+	std::cout << "\n================ Sharded Runs ================\n";
+	std::cout << "Runs merged: " << runs << std::endl;
+	if (cachedShards > 0)
+		std::cout << "Shards read from cache: " << cachedShards << std::endl;
+	std::cout << "Lost shards: " << lostShards.size();
+	for (size_t shard : lostShards)
+		std::cout << " #" << shard;
+	std::cout << std::endl;
+	std::cout << "Totals are means per run; Notes shows the most frequent winner." << std::endl;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "CompactPlayer.h"
+
+class Game;
+class ResultCache;
+
+// Runs many compact tournaments in separate worker processes.
+// Runs are grouped into shards of consecutive seeds; workers claim shards
+// one at a time from a shared counter and write each finished shard into
+// its own slot of a shared memory segment. A worker that crashes loses
+// only the shard it was playing, and the parent starts a replacement
+// while unclaimed shards remain.
+class ShardedRunner
+{
+	std::vector<const Game*> games;
+	Population population;
+	uint64_t seed;
+
+	// Merged over every finished shard
+	uint64_t runs = 0;
+	std::vector<uint64_t> initial, survivors, deaths;
+	std::vector<std::map<uint32_t, std::pair<uint64_t, CompactPlayer>>> wins;	// per game: number -> (wins, player)
+	std::vector<size_t> lostShards;
+	size_t cachedShards = 0;
+
+	size_t slotSize(size_t shardRuns) const;
+	size_t payloadSize(uint64_t runs) const;
+	void loadCached(void* segment, size_t shardCount, size_t shardRuns, uint64_t totalRuns, const ResultCache& cache, std::vector<bool>& cached);
+	void playShards(void* segment, size_t shardCount, size_t shardRuns, uint64_t totalRuns);
+public:
+	// Run r plays every game on a copy of population with seed + r
+	ShardedRunner(const std::vector<const Game*>& games, const Population& population, uint64_t seed);
+
+	// Plays totalRuns tournaments in shards of shardRuns on workers processes.
+	// With a cache, shards it already holds are read from it instead of
+	// played, and newly played shards are added to it.
+	void run(unsigned int workers, uint64_t totalRuns, size_t shardRuns = 64, ResultCache* cache = nullptr);
+
+	// Stores the per-run means and the most frequent winner of each game
+	// in games, so their printSummary() shows the merged result
+	void applyTo(const std::vector<Game*>& games) const;
+	void printReport() const;
+
+	uint64_t getRunCount() const { return runs; }
+	const std::vector<size_t>& getLostShards() const { return lostShards; }
+	size_t getCachedShardCount() const { return cachedShards; }
+};
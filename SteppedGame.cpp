@@ -0,0 +1,127 @@
+#include <algorithm>
+#include "Game.h"
+
+// Coroutine versions of the games.
+// Each playSteps() plays the same rounds as playCompact() without a
+// scheduler, through the same per-round member, and suspends after every
+// round so many small tournaments can take turns on one thread.
+
+#ifdef __cpp_impl_coroutine
+
+// Games without rounds of their own are a single round
+GameSteps Game::playSteps(Population& population, RandomBuffer& rng)
+{
+	playCompact(population, rng);
+	co_yield 1;
+}
+
+
+// One round per turn; the light phases share one timeline and run as one round
+GameSteps RedLightGreenLight::playSteps(Population& population, RandomBuffer& rng)
+{
+	if (compactLights.getOptions().enabled)
+	{
+		playCompact(population, rng);
+		co_yield 1;
+		co_return;
+	}
+
+	initial_count = population.size();
+
+	CompactPlayer* first = population.data();
+	CompactPlayer* last = first + population.size();
+	for (CompactPlayer* p = first; p != last; ++p)
+	{
+		p->set(CompactPlayer::Playing);
+		p->setState(0);
+	}
+
+	for (unsigned int t = 0; t < turn; ++t)
+	{
+		playTurn(first, last, t, rng);
+		co_yield t + 1;
+	}
+
+	population.erase(std::remove_if(population.begin(), population.end(),
+		[](const CompactPlayer& p) { return p.has(CompactPlayer::Playing); }), population.end());
+
+	survivor_count = population.size();
+	death_count = initial_count - survivor_count;
+}
+
+
+GameSteps Marbles::playSteps(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	if (population.size() < 2)
+		co_return;
+
+	compactBracket.reset();
+	while (compactBracket.hasNextRound(population.size()))
+	{
+		playRound(population, rng);
+		survivor_count = population.size();
+		death_count = initial_count - survivor_count;
+		co_yield compactBracket.getRound();
+	}
+}
+
+
+GameSteps Ddakji::playSteps(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+
+	if (population.size() < 2)
+		co_return;
+
+	compactBracket.reset();
+	while (compactBracket.hasNextRound(population.size()))
+	{
+		playRound(population, rng);
+		survivor_count = population.size();
+		death_count = initial_count - survivor_count;
+		co_yield compactBracket.getRound();
+	}
+}
+
+
+GameSteps Pysical_Asia_ship::playSteps(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+	round_count = 0;
+
+	survivor_count = population.size();
+	death_count = 0;
+	while (population.size() > 2)
+	{
+		playRound(population, rng);
+		survivor_count = population.size();
+		death_count = initial_count - survivor_count;
+		co_yield round_count;
+	}
+}
+
+
+GameSteps SquidGame::playSteps(Population& population, RandomBuffer& rng)
+{
+	initial_count = population.size();
+	compact_winner = CompactPlayer();
+
+	if (population.size() < 2)
+		co_return;
+
+	unsigned int rounds = 0;
+	while (population.size() > 1)
+	{
+		playRound(population, rng);
+		survivor_count = population.size();
+		death_count = initial_count - survivor_count;
+		co_yield ++rounds;
+	}
+
+	if (survivor_count == 1)
+		compact_winner = population.front();
+}
+
+#endif
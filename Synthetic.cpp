@@ -0,0 +1,20 @@
+#include "Synthetic.h"
+#include "Scheduler.h"
+
+void SyntheticPopulation::fill(Population& population, size_t count, TaskScheduler* scheduler) const
+{
+	const size_t grain = 1 << 16;
+
+	population.resize(count);
+	CompactPlayer* players = population.data();
+
+	auto build = [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i)
+			players[i] = makePlayer(uint32_t(i + 1));
+	};
+
+	if (scheduler && count > grain)
+		scheduler->parallelFor(0, count, grain, build);
+	else
+		build(0, count);
+}
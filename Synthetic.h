@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "CompactPlayer.h"
+
+class TaskScheduler;
+
+// Player attributes as a pure function of (population seed, player number).
+// Nothing is drawn from a shared engine, so any player of a population of
+// any size can be built, or rebuilt, on its own and in any order.
+class SyntheticPopulation
+{
+	uint64_t key;
+
+	uint64_t hash(uint32_t number) const { return mix(key ^ (uint64_t(number) * 0x9E3779B97F4A7C15ull)); }
+
+	// Uniform in [0, 100] from 32 random bits by multiply-shift
+	static unsigned int toAbility(uint32_t bits) { return unsigned((uint64_t(bits) * 101) >> 32); }
+public:
+	SyntheticPopulation(uint64_t seed) : key(mix(seed)) {};
+
+	// splitmix64 finalizer: a bijective 64-bit mix with full avalanche
+	static uint64_t mix(uint64_t x)
+	{
+		x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+		x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+		return x ^ (x >> 31);
+	}
+
+	unsigned int getAgility(uint32_t number) const { return toAbility(uint32_t(hash(number))); }
+	unsigned int getFearlessness(uint32_t number) const { return toAbility(uint32_t(hash(number) >> 32)); }
+
+	CompactPlayer makePlayer(uint32_t number) const
+	{
+		uint64_t h = hash(number);
+		return CompactPlayer(number, toAbility(uint32_t(h)), toAbility(uint32_t(h >> 32)));
+	}
+
+	// Fills population with players 1..count, in parallel chunks when a
+	// scheduler is given
+	void fill(Population& population, size_t count, TaskScheduler* scheduler = nullptr) const;
+};
@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "CompactPlayer.h"
+#include "Random.h"
+
+// How a tug of war splits its players into teams and how long it goes on
+struct RopeOptions
+{
+	enum Split
+	{
+		Alternate,		// even against odd positions of the line-up
+		Rotate,			// the most even of every rotation of the line-up
+		Swap			// the alternating split, evened by the best of some random pair swaps
+	};
+
+	Split split = Alternate;
+	unsigned int rounds = 1;		// rope rounds; each halves the players unless it ties
+	unsigned int candidates = 64;	// Swap: pair swaps tried per round
+};
+
+// Summed powers of the two sides of a tug of war
+struct TeamPowers
+{
+	int64_t power[2] = { 0, 0 };
+
+	// 0 or 1 for the weaker team, -1 for a tie
+	int getLosingTeam() const
+	{
+		if (power[0] > power[1])
+			return 1;
+		if (power[1] > power[0])
+			return 0;
+		return -1;
+	}
+
+	int64_t getGap() const { return power[0] > power[1] ? power[0] - power[1] : power[1] - power[0]; }
+
+	// A player of the given power changes sides, so a split that differs
+	// from another by a few players costs one update per player
+	void move(int64_t playerPower, int from)
+	{
+		power[from] -= playerPower;
+		power[1 - from] += playerPower;
+	}
+};
+
+// Player powers for compact records and Player objects
+inline int64_t teamPower(const CompactPlayer& player) { return player.getPower(); }
+template <class P> int64_t teamPower(const P* player) { return player->getPower(); }
+
+// Players first, first + stride, first + 2 * stride, ... of a line-up of
+// count players, split alternately and summed where they stand. A round
+// reads only the players still in it, so rounds that keep halving the
+// line-up cost O(n) together and need no memory of their own.
+template <class T>
+TeamPowers splitStrided(const T* players, size_t count, size_t first, size_t stride)
+{
+	TeamPowers teams;
+	size_t i = first;
+	for (; i + stride < count; i += 2 * stride)
+	{
+		teams.power[0] += teamPower(players[i]);
+		teams.power[1] += teamPower(players[i + stride]);
+	}
+	if (i < count)
+		teams.power[0] += teamPower(players[i]);
+	return teams;
+}
+
+// Powers of a line-up of players as prefix sums, plain and alternating
+// (even positions minus odd ones), filled in one pass. The alternating
+// split of any run of the line-up, or of any rotation of it, is then read
+// in O(1) instead of summing the players again.
+class PowerColumn
+{
+	std::vector<int64_t> sums;			// sums[i]: players [0, i)
+	std::vector<int64_t> alternating;	// alternating[i]: even minus odd positions of [0, i)
+public:
+	void reserve(size_t count)
+	{
+		sums.reserve(count + 1);
+		alternating.reserve(count + 1);
+	}
+
+	template <class T>
+	void assign(const T* players, size_t count)
+	{
+		sums.resize(count + 1);
+		alternating.resize(count + 1);
+		sums[0] = alternating[0] = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			int64_t power = teamPower(players[i]);
+			sums[i + 1] = sums[i] + power;
+			alternating[i + 1] = alternating[i] + (i % 2 == 0 ? power : -power);
+		}
+	}
+
+	size_t size() const { return sums.empty() ? 0 : sums.size() - 1; }
+	int64_t getPower(size_t i) const { return sums[i + 1] - sums[i]; }
+
+	// Team 0 is players first, first + 2, ... of [first, last), team 1 the rest
+	TeamPowers split(size_t first, size_t last) const
+	{
+		int64_t total = sums[last] - sums[first];
+		int64_t difference = alternating[last] - alternating[first];
+		if (first % 2 == 1)
+			difference = -difference;
+
+		TeamPowers teams;
+		teams.power[0] = (total + difference) / 2;
+		teams.power[1] = (total - difference) / 2;
+		return teams;
+	}
+
+	// The alternating split of the line-up rotated left by shift
+	TeamPowers rotation(size_t shift) const
+	{
+		TeamPowers teams = split(shift, size());
+		TeamPowers wrapped = split(0, shift);
+		int flip = int((size() - shift) % 2);
+		teams.power[0] += wrapped.power[flip];
+		teams.power[1] += wrapped.power[1 - flip];
+		return teams;
+	}
+};
+
+// Lines up the count players of one Rotate or Swap round in place, so the
+// round is then the alternating split of players, and returns its team
+// powers. Every candidate split is read off column: a rotation in O(1),
+// a pair swap as two moves from the alternating split. The first of
+// equally even candidates wins, so with no better one the line-up stays.
+template <class T>
+TeamPowers arrangeRope(T* players, size_t count, const RopeOptions& options, PowerColumn& column, RandomBuffer& rng)
+{
+	column.assign(players, count);
+	TeamPowers best = column.split(0, count);
+
+	if (options.split == RopeOptions::Rotate)
+	{
+		size_t bestShift = 0;
+		for (size_t shift = 1; shift < count && best.getGap() > 0; ++shift)
+		{
+			TeamPowers teams = column.rotation(shift);
+			if (teams.getGap() < best.getGap())
+			{
+				best = teams;
+				bestShift = shift;
+			}
+		}
+		std::rotate(players, players + bestShift, players + count);
+	}
+	else if (options.split == RopeOptions::Swap && count >= 2)
+	{
+		TeamPowers teams = best;
+		size_t bestFrom = 0, bestTo = 0;
+		for (unsigned int c = 0; c < options.candidates; ++c)
+		{
+			size_t from = 2 * size_t(rng.nextBelow(unsigned((count + 1) / 2)));
+			size_t to = 2 * size_t(rng.nextBelow(unsigned(count / 2))) + 1;
+
+			TeamPowers swapped = teams;
+			swapped.move(column.getPower(from), 0);
+			swapped.move(column.getPower(to), 1);
+			if (swapped.getGap() < best.getGap())
+			{
+				best = swapped;
+				bestFrom = from;
+				bestTo = to;
+			}
+		}
+		std::swap(players[bestFrom], players[bestTo]);
+	}
+	return best;
+}
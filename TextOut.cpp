@@ -0,0 +1,188 @@
+#include <cmath>
+#include <cstring>
+#include "TextOut.h"
+
+namespace
+{
+	// Writes value backwards ending at end; returns the first digit
+	char* formatDigits(char* end, unsigned long long value)
+	{
+		do
+		{
+			*--end = char('0' + value % 10);
+			value /= 10;
+		} while (value != 0);
+		return end;
+	}
+
+	const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+}
+
+TextOut& TextOut::standard()
+{
+	static TextOut out(stdout);
+	return out;
+}
+
+TextOut::TextOut(FILE* file, size_t capacity)
+	: file(file), buffer(new char[capacity < 2 * maxNumber ? 2 * maxNumber : capacity]),
+	capacity(capacity < 2 * maxNumber ? 2 * maxNumber : capacity)
+{
+}
+
+TextOut::~TextOut()
+{
+	flush();
+	delete[] buffer;
+}
+
+void TextOut::flush()
+{
+	if (length > 0)
+		fwrite(buffer, 1, length, file);
+	length = 0;
+	fflush(file);
+}
+
+TextOut& TextOut::operator<<(const char* text)
+{
+	return write(text, strlen(text));
+}
+
+TextOut& TextOut::write(const char* text, size_t count)
+{
+	while (count > 0)
+	{
+		if (length == capacity)
+			flush();
+		size_t part = capacity - length < count ? capacity - length : count;
+		memcpy(buffer + length, text, part);
+		length += part;
+		text += part;
+		count -= part;
+	}
+	return *this;
+}
+
+TextOut& TextOut::writeUnsigned(unsigned long long value)
+{
+	char digits[maxNumber];
+	char* first = formatDigits(digits + maxNumber, value);
+	return write(first, digits + maxNumber - first);
+}
+
+TextOut& TextOut::writeSigned(long long value)
+{
+	if (value >= 0)
+		return writeUnsigned((unsigned long long)value);
+
+	*this << '-';
+	return writeUnsigned(0ull - (unsigned long long)value);
+}
+
+// Exact reproduces %g with six significant digits: the six digits are
+// rounded from the double, and anything the fast path cannot decide
+// for certain (large or tiny magnitudes, values too close to a rounding
+// tie) goes through snprintf, so the output always matches iostream.
+TextOut& TextOut::writeFloat(double value)
+{
+	char* out = reserve();
+
+	if (floatStyle == Short && std::isfinite(value) && std::fabs(value) < 1e15)
+	{
+		double scaled = std::nearbyint(std::fabs(value) * 1000.0);
+		unsigned long long whole = (unsigned long long)scaled;
+		char digits[maxNumber];
+		char* first = formatDigits(digits + maxNumber, whole / 1000);
+		char* p = out;
+		if (std::signbit(value) && whole != 0)
+			*p++ = '-';
+		memcpy(p, first, digits + maxNumber - first);
+		p += digits + maxNumber - first;
+		*p++ = '.';
+		unsigned fraction = unsigned(whole % 1000);
+		*p++ = char('0' + fraction / 100);
+		*p++ = char('0' + fraction / 10 % 10);
+		*p++ = char('0' + fraction % 10);
+		length += p - out;
+		return *this;
+	}
+
+	double magnitude = std::fabs(value);
+	if (magnitude == 0.0 && !std::signbit(value))
+	{
+		*out = '0';
+		length++;
+		return *this;
+	}
+
+	// Fast path: 1e-4 <= |value| < 1e5, where %g uses plain notation
+	if (magnitude >= 1e-4 && magnitude < 1e5)
+	{
+		int exponent = int(std::floor(std::log10(magnitude)));
+		double scaled = exponent <= 5 ? magnitude * powersOfTen[5 - exponent] : 0;
+		if (scaled >= 1e6)
+		{
+			exponent++;
+			scaled = magnitude * powersOfTen[5 - exponent];
+		}
+		else if (scaled < 1e5)
+		{
+			exponent--;
+			scaled = magnitude * powersOfTen[5 - exponent];
+		}
+
+		double whole = std::floor(scaled);
+		double fraction = scaled - whole;
+		if (scaled >= 1e5 && scaled < 1e6 && std::fabs(fraction - 0.5) > 1e-6)
+		{
+			unsigned long digits = (unsigned long)whole + (fraction > 0.5 ? 1 : 0);
+			if (digits == 1000000)
+			{
+				digits = 100000;
+				exponent++;
+			}
+
+			if (exponent < 5)
+			{
+				char text[8];
+				formatDigits(text + 6, digits);
+
+				// Trailing zeros after the point are dropped
+				int significant = 6;
+				while (significant > exponent + 1 && significant > 1 && text[significant - 1] == '0')
+					significant--;
+
+				char* p = out;
+				if (value < 0)
+					*p++ = '-';
+				if (exponent < 0)
+				{
+					*p++ = '0';
+					*p++ = '.';
+					for (int z = -1; z > exponent; --z)
+						*p++ = '0';
+					memcpy(p, text, significant);
+					p += significant;
+				}
+				else
+				{
+					memcpy(p, text, exponent + 1);
+					p += exponent + 1;
+					if (significant > exponent + 1)
+					{
+						*p++ = '.';
+						memcpy(p, text + exponent + 1, significant - exponent - 1);
+						p += significant - exponent - 1;
+					}
+				}
+				length += p - out;
+				return *this;
+			}
+		}
+	}
+
+	int written = snprintf(out, maxNumber, "%g", value);
+	length += written > 0 ? size_t(written) : 0;
+	return *this;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Buffered text output for the per-player messages of play().
+// Messages are rendered into one large reusable buffer with hand-rolled
+// integer and float conversion and written out in big blocks, instead of
+// going through iostream formatting and a flush per line.
+// Call flush() before writing to the same file any other way.
+class TextOut
+{
+public:
+	enum FloatStyle
+	{
+		Exact,	// the digits std::ostream prints by default (%g, 6 significant)
+		Short	// fixed three decimals, cheaper to render
+	};
+
+	// Shared writer for standard output
+	static TextOut& standard();
+
+	TextOut(FILE* file, size_t capacity = 1 << 20);
+	~TextOut();
+
+	TextOut& operator<<(const char* text);
+	TextOut& operator<<(const std::string& text) { return write(text.data(), text.size()); }
+	TextOut& operator<<(char c)
+	{
+		if (length == capacity)
+			flush();
+		buffer[length++] = c;
+		return *this;
+	}
+	TextOut& operator<<(int value) { return writeSigned(value); }
+	TextOut& operator<<(long value) { return writeSigned(value); }
+	TextOut& operator<<(long long value) { return writeSigned(value); }
+	TextOut& operator<<(unsigned int value) { return writeUnsigned(value); }
+	TextOut& operator<<(unsigned long value) { return writeUnsigned(value); }
+	TextOut& operator<<(unsigned long long value) { return writeUnsigned(value); }
+	TextOut& operator<<(float value) { return writeFloat(value); }
+	TextOut& operator<<(double value) { return writeFloat(value); }
+
+	TextOut& write(const char* text, size_t count);
+	void flush();
+
+	void setFloatStyle(FloatStyle style) { floatStyle = style; }
+	FloatStyle getFloatStyle() const { return floatStyle; }
+
+private:
+	// Worst case of any single number
+	static const size_t maxNumber = 32;
+
+	FILE* file;
+	char* buffer;
+	size_t capacity;
+	size_t length = 0;
+	FloatStyle floatStyle = Exact;
+
+	char* reserve()
+	{
+		if (capacity - length < maxNumber)
+			flush();
+		return buffer + length;
+	}
+
+	TextOut& writeSigned(long long value);
+	TextOut& writeUnsigned(unsigned long long value);
+	TextOut& writeFloat(double value);
+};
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include "Tournament.h"
+#include "Game.h"
+#include "ImportanceSampling.h"
+#include "Metrics.h"
+
+TournamentRunner::TournamentRunner(const std::vector<const Game*>& prototypes)
+	: rng(0)
+{
+	for (auto prototype : prototypes)
+		games.emplace_back(prototype->clone());
+	records.resize(games.size());
+}
+
+TournamentRunner::~TournamentRunner()
+{
+}
+
+void TournamentRunner::setSampler(ImportanceSampler* sampler)
+{
+	this->sampler = sampler;
+	for (auto& game : games)
+		game->setSampler(sampler);
+}
+
+void TournamentRunner::setScheduler(TaskScheduler* scheduler)
+{
+	for (auto& game : games)
+		game->setScheduler(scheduler);
+}
+
+GameRecord makeRecord(const Game& game)
+{
+	GameRecord record;
+	record.initial_count = game.getInitialCount();
+	record.survivor_count = game.getSurvivorCount();
+	record.death_count = game.getDeathCount();
+	record.winner = game.getCompactWinner();
+	record.step_count = game.getStepCount();
+	record.round_count = game.getRoundCount();
+	return record;
+}
+
+void TournamentRunner::run(const Population& start, uint64_t seed)
+{
+	if (sampler)
+		sampler->reset();
+
+	rng.reseed(seed);
+
+	// Scratch buffers only ever grow, so after the first run on a
+	// population of this size no run allocates. Runs keep passing the same
+	// start population, which is scanned for its numbers only once.
+	if (start.data() != reservedFor || start.size() != reservedCount)
+	{
+		int maxNumber = 0;
+		for (auto& player : start)
+			maxNumber = std::max(maxNumber, player.getNumber());
+		for (auto& game : games)
+			game->reserve(start.size(), maxNumber);
+
+		reservedFor = start.data();
+		reservedCount = start.size();
+	}
+
+	population.reserve(start.size());
+	population.assign(start.begin(), start.end());
+
+	for (size_t i = 0; i < games.size(); ++i)
+	{
+		Game& game = *games[i];
+		game.resetStats();
+		game.playCompact(population, rng);
+
+		records[i] = makeRecord(game);
+	}
+
+	if (Metrics::isEnabled())
+	{
+		Metrics::Block& block = Metrics::local();
+		for (size_t i = 0; i < records.size(); ++i)
+			block.addGame(i, records[i].initial_count, records[i].survivor_count);
+		block.addRun();
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "CompactPlayer.h"
+#include "Random.h"
+
+class Game;
+class ImportanceSampler;
+class TaskScheduler;
+
+// Statistics of one game in one tournament run
+struct GameRecord
+{
+	unsigned int initial_count = 0;
+	unsigned int survivor_count = 0;
+	unsigned int death_count = 0;
+	CompactPlayer winner;
+	unsigned int step_count = 0;	// Glass Bridge only
+	unsigned int round_count = 0;	// Pysical Asia Ship only
+};
+
+// Statistics of the game's last play
+GameRecord makeRecord(const Game& game);
+
+// Plays the compact tournament repeatedly on one thread.
+// Owns clones of the prototype games and its population buffer,
+// so consecutive runs reuse the same objects.
+class TournamentRunner
+{
+	std::vector<std::unique_ptr<Game>> games;
+	std::vector<GameRecord> records;
+	Population population;
+	RandomBuffer rng;
+	ImportanceSampler* sampler = nullptr;
+	const CompactPlayer* reservedFor = nullptr;		// start population the games' buffers were sized for
+	size_t reservedCount = 0;
+public:
+	TournamentRunner(const std::vector<const Game*>& prototypes);
+	~TournamentRunner();
+
+	// A runner made on a pinned worker (--numa) keeps its random state on
+	// that worker's node, next to its games
+	static void* operator new(size_t bytes) { return NodeArena::allocateLocal(bytes); }
+	static void operator delete(void* pointer) { NodeArena::releaseLocal(pointer); }
+
+	// Attaches an importance sampler to every game; its weight is reset per run
+	void setSampler(ImportanceSampler* sampler);
+
+	// Lets the games split large populations into tasks on this scheduler
+	void setScheduler(TaskScheduler* scheduler);
+
+	// Plays every game on a copy of start with the given seed
+	void run(const Population& start, uint64_t seed);
+
+	size_t getGameCount() const { return games.size(); }
+	const Game& getGame(size_t index) const { return *games[index]; }
+	const std::vector<GameRecord>& getRecords() const { return records; }
+	const Population& getSurvivors() const { return population; }
+};
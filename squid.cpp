@@ -1,25 +1,64 @@
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <map>
+#include <memory>
 #include "Player.h"
 #include "Game.h"
+#include "Branching.h"
+#include "MonteCarlo.h"
+#include "ImportanceSampling.h"
+#include "Scheduler.h"
+#include "Sharding.h"
+#include "PlayerIndex.h"
+#include "Synthetic.h"
+#include "Interleaving.h"
+#include "Metrics.h"
+#include "Lanes.h"
+#include "ResultCache.h"
 
-int main()
+// Creates the eight games in tournament order.
+// Red Light Green Light uses the given light phases, Tug of War splits
+// its teams and plays its rope rounds as given, and Marbles and Ddakji run their rounds
+// with the given bracket options.
+static std::vector<Game*> makeGames(const LightOptions& lights, const RopeOptions& rope, const BracketOptions& bracket)
 {
-    std::list<Player*> players;
-    for (int i = 0; i < 456; ++i)
-    {
-        players.push_back(new Player(i+1));
-    }
-    
     std::vector<Game*> games;
-    games.push_back(new RedLightGreenLight(20));
+    games.push_back(new RedLightGreenLight(20, lights));
     games.push_back(new RPS());
-    games.push_back(new TugOfWar());
+    games.push_back(new TugOfWar(rope));
     games.push_back(new GlassBridge());
-    games.push_back(new Marbles());
-    games.push_back(new Ddakji());
+    games.push_back(new Marbles(bracket));
+    games.push_back(new Ddakji(bracket));
     games.push_back(new Pysical_Asia_ship());
     games.push_back(new SquidGame());
-    
+    return games;
+}
+
+static void printSummaryTable(const std::vector<Game*>& games)
+{
+    std::cout << "\n================ Game Summary ================\n";
+    std::cout << "| Game | Total | Survivors | Deaths | Death Rate | Notes |\n";
+    std::cout << "---------------------------------------------\n";
+
+    for (Game* game : games) {
+        game->printSummary();
+    }
+}
+
+// Plays the tournament with full Player objects and messages
+static void runClassic(int playerCount, const SyntheticPopulation* synthetic, std::vector<Game*>& games)
+{
+    std::list<Player*> players;
+    for (int i = 0; i < playerCount; ++i)
+    {
+        if (synthetic)
+            players.push_back(new Player(i + 1, synthetic->getAgility(i + 1), synthetic->getFearlessness(i + 1)));
+        else
+            players.push_back(new Player(i+1));
+    }
+
     for (auto game : games)
     {
         for (auto player : players)
@@ -27,10 +66,15 @@ int main()
 
         game->play();
 
+        // Game messages are buffered; write them out before the next game
+        TextOut::standard().flush();
+
         auto alivePlayers = game->getAlivePlayers();
 
         // 원본 players는 게임에 join할 때만 참조용으로 사용
         // 실제 게임 플레이어는 게임 내부에서 생성/관리됨
+        for (auto player : players)
+            delete player;
         players.clear();
 
         for (auto player : alivePlayers)
@@ -39,19 +83,467 @@ int main()
         }
     }
 
-    std::cout << "\n================ Game Summary ================\n";
+    // 마지막 남은 players 정리
+    for (auto player : players)
+        delete player;
+}
+
+// Plays the tournament quietly on 8-byte CompactPlayer records,
+// which keeps 100M+ player populations within a few GB.
+// A synthetic population is built from its hash instead of rng, in
+// parallel when a scheduler is given.
+static Population makePopulation(unsigned int playerCount, RandomBuffer& rng,
+    const SyntheticPopulation* synthetic = nullptr, TaskScheduler* scheduler = nullptr)
+{
+    Population population;
+    if (synthetic)
+    {
+        synthetic->fill(population, playerCount, scheduler);
+        return population;
+    }
+
+    population.resize(playerCount);
+    for (unsigned int i = 0; i < playerCount; ++i)
+    {
+        unsigned int agility = rng.nextBelow(101);
+        population[i] = CompactPlayer(i + 1, agility, rng.nextBelow(101));
+    }
+    return population;
+}
+
+static void runCompact(unsigned int playerCount, uint64_t seed, const SyntheticPopulation* synthetic, std::vector<Game*>& games, TaskScheduler& scheduler,
+    PlayerTracker& tracker)
+{
+    RandomBuffer rng(seed);
+    Population population = makePopulation(playerCount, rng, synthetic, &scheduler);
+
+    if (!tracker.isEmpty())
+        tracker.start(population);
+
+    for (size_t i = 0; i < games.size(); ++i)
+    {
+        games[i]->setScheduler(&scheduler);
+        games[i]->playCompact(population, rng);
+
+        if (!tracker.isEmpty())
+            tracker.afterGame(i, population);
+    }
+}
+
+// Plays games 0..forkAt-1 once, then forks branchCount continuations of the
+// remaining games from the shared survivors, each with its own seed
+static void runForked(unsigned int playerCount, uint64_t seed, const SyntheticPopulation* synthetic, std::vector<Game*>& games,
+    size_t forkAt, unsigned int branchCount, TaskScheduler& scheduler)
+{
+    RandomBuffer rng(seed);
+    Population population = makePopulation(playerCount, rng, synthetic, &scheduler);
+
+    for (size_t i = 0; i < forkAt; ++i)
+        games[i]->playCompact(population, rng);
+
+    TournamentFork fork(PopulationSnapshot(std::move(population), forkAt));
+    std::vector<const Game*> continuation(games.begin() + forkAt, games.end());
+    for (unsigned int b = 0; b < branchCount; ++b)
+        fork.addBranch(seed + 1 + b, continuation);
+
+    fork.run(&scheduler);
+
+    std::cout << "\n================ Shared Prefix ================\n";
     std::cout << "| Game | Total | Survivors | Deaths | Death Rate | Notes |\n";
     std::cout << "---------------------------------------------\n";
+    for (size_t i = 0; i < forkAt; ++i)
+        games[i]->printSummary();
 
-    for (Game* game : games) {
-        game->printSummary();
+    std::cout << "\n================ " << branchCount << " Branches ================\n";
+    std::cout << "| Game | Mean Total | Mean Survivors | Mean Deaths |\n";
+    std::cout << "---------------------------------------------\n";
+
+    std::map<int, unsigned int> wins;
+    for (size_t g = 0; g < continuation.size(); ++g)
+    {
+        double total = 0, survivors = 0, deaths = 0;
+        for (size_t b = 0; b < fork.getBranchCount(); ++b)
+        {
+            const GameRecord& result = fork.getResults(b)[g];
+            total += result.initial_count;
+            survivors += result.survivor_count;
+            deaths += result.death_count;
+            if (result.winner.getNumber() != 0)
+                wins[result.winner.getNumber()]++;
+        }
+        std::cout << "| " << continuation[g]->getName()
+                  << " | " << total / branchCount
+                  << " | " << survivors / branchCount
+                  << " | " << deaths / branchCount << " |" << std::endl;
     }
 
+    std::cout << "\n[Winners]" << std::endl;
+    for (auto& win : wins)
+        std::cout << "Player #" << win.first << ": " << win.second << " wins" << std::endl;
+}
+
+// Estimates every game's death rate and the tracked players' win
+// probabilities, adding runs until each interval is narrower than the target
+// With exportPath set, every run's per-game records are also written there
+static void runEstimate(unsigned int playerCount, uint64_t seed, const SyntheticPopulation* synthetic, std::vector<Game*>& games,
+    AdaptiveOptions options, const std::vector<int>& trackedPlayers,
+    const char* exportPath, ResultWriter::Format exportFormat)
+{
+    RandomBuffer rng(seed);
+    Population population = makePopulation(playerCount, rng, synthetic, options.scheduler);
+
+    AdaptiveMonteCarlo estimator(std::vector<const Game*>(games.begin(), games.end()), population, seed + 1);
+    for (int number : trackedPlayers)
+        estimator.trackWinner(number);
+
+    std::unique_ptr<ResultWriter> writer;
+    if (exportPath)
+    {
+        std::vector<std::string> names;
+        for (auto game : games)
+            names.push_back(game->getName());
+
+        writer.reset(new ResultWriter(exportPath, exportFormat, names));
+        if (!writer->isOpen())
+        {
+            std::cerr << "Cannot open " << exportPath << std::endl;
+            return;
+        }
+        options.writer = writer.get();
+    }
+
+    estimator.run(options);
+    estimator.printReport();
+
+    if (writer)
+        std::cout << "Exported " << writer->getRowCount() << " rows to " << exportPath << std::endl;
+}
+
+// Estimates one player's win probability with importance sampling
+static void runRareEvent(unsigned int playerCount, uint64_t seed, const SyntheticPopulation* synthetic, std::vector<Game*>& games,
+    int target, float bias, uint64_t runs, TaskScheduler& scheduler)
+{
+    RandomBuffer rng(seed);
+    Population population = makePopulation(playerCount, rng, synthetic, &scheduler);
+
+    RareEventEstimator estimator(std::vector<const Game*>(games.begin(), games.end()), population, seed + 1, target, bias);
+    estimator.run(runs, &scheduler);
+    estimator.printReport();
+}
+
+// Plays many tournaments in worker processes and prints the merged summary.
+// With cacheDir set, shards finished by earlier invocations are reused.
+static void runSharded(unsigned int playerCount, uint64_t seed, const SyntheticPopulation* synthetic, std::vector<Game*>& games,
+    unsigned int processCount, uint64_t runs, size_t shardRuns, const char* cacheDir)
+{
+    RandomBuffer rng(seed);
+    Population population = makePopulation(playerCount, rng, synthetic);
+    std::vector<const Game*> prototypes(games.begin(), games.end());
+
+    std::unique_ptr<ResultCache> cache;
+    if (cacheDir)
+        cache.reset(new ResultCache(cacheDir, ResultCache::makeKey(prototypes, population, seed + 1)));
+
+    ShardedRunner runner(prototypes, population, seed + 1);
+    runner.run(processCount, runs, shardRuns, cache.get());
+    runner.applyTo(games);
+
+    printSummaryTable(games);
+    runner.printReport();
+}
+
+// Plays many small tournaments 64 at a time in bit lanes and prints the merged summary
+static void runLanes(unsigned int playerCount, uint64_t seed, const SyntheticPopulation* synthetic, std::vector<Game*>& games,
+    uint64_t runs, double maxSeconds, TaskScheduler& scheduler)
+{
+    RandomBuffer rng(seed);
+    Population population = makePopulation(playerCount, rng, synthetic, &scheduler);
+
+    LaneRunner runner(std::vector<const Game*>(games.begin(), games.end()), population, seed);
+    runner.run(runs, &scheduler, maxSeconds);
+    runner.applyTo(games);
+
+    printSummaryTable(games);
+    runner.printReport();
+}
+
+#ifdef __cpp_impl_coroutine
+// Plays many small tournaments interleaved a round at a time and prints the merged summary
+static void runInterleaved(unsigned int playerCount, uint64_t seed, const SyntheticPopulation* synthetic, std::vector<Game*>& games,
+    size_t width, uint64_t runs, double maxSeconds, TaskScheduler& scheduler)
+{
+    RandomBuffer rng(seed);
+    Population population = makePopulation(playerCount, rng, synthetic, &scheduler);
+
+    InterleavedRunner runner(std::vector<const Game*>(games.begin(), games.end()), population, seed);
+    runner.run(runs, width, &scheduler, maxSeconds);
+    runner.applyTo(games);
+
+    printSummaryTable(games);
+    runner.printReport();
+}
+#endif
+
+static bool parseSeeding(const char* name, BracketOptions::Seeding& seeding)
+{
+    if (strcmp(name, "adjacent") == 0)
+        seeding = BracketOptions::Adjacent;
+    else if (strcmp(name, "shuffle") == 0)
+        seeding = BracketOptions::Shuffle;
+    else if (strcmp(name, "power") == 0)
+        seeding = BracketOptions::PowerSorted;
+    else
+        return false;
+    return true;
+}
+
+static bool parseRopeSplit(const char* name, RopeOptions::Split& split)
+{
+    if (strcmp(name, "alternate") == 0)
+        split = RopeOptions::Alternate;
+    else if (strcmp(name, "rotate") == 0)
+        split = RopeOptions::Rotate;
+    else if (strcmp(name, "swap") == 0)
+        split = RopeOptions::Swap;
+    else
+        return false;
+    return true;
+}
+
+// The doll has to turn around before the shortest red light ends
+static bool parseLookDelay(const char* text, LightOptions& lights)
+{
+    char* end = nullptr;
+    unsigned long delay = strtoul(text, &end, 10);
+    if (end == text || *end != '\0' || delay >= lights.redMin)
+    {
+        std::cerr << "--look-delay must be below " << lights.redMin << " ms" << std::endl;
+        return false;
+    }
+    lights.lookDelay = (unsigned int)delay;
+    return true;
+}
+
+static const char* usage =
+    " [--compact [--follow NUMBER]...] [--players N] [--seed S] [--fork K --branches N]"
+    " [--estimate WIDTH [--track NUMBER]... [--max-runs R] [--max-seconds T] [--export FILE [--csv]]]"
+    " [--rare NUMBER [--bias B] [--max-runs R]] [--numa]"
+    " [--processes P --runs R [--shard-size S] [--cache DIR]]"
+    " [--seeding adjacent|shuffle|power] [--bracket-rounds R] [--bracket-target T]"
+    " [--lights [--look-delay MS]] [--rope-rounds R]"
+    " [--rope-split alternate|rotate|swap [--rope-candidates K]] [--synthetic]"
+    " [--interleave WIDTH --runs R [--max-seconds T]] [--lanes --runs R [--max-seconds T]] [--short-floats]"
+    " [--metrics FILE] [--metrics-port PORT] [--metrics-interval SEC]";
+
+int main(int argc, char** argv)
+{
+    bool compact = false;
+    unsigned int playerCount = 456;
+    uint64_t seed = time(nullptr);
+    size_t forkAt = 0;
+    unsigned int branchCount = 0;
+    bool estimate = false;
+    AdaptiveOptions estimateOptions;
+    std::vector<int> trackedPlayers;
+    int rareTarget = 0;
+    float rareBias = 0.3f;
+    uint64_t rareRuns = 1000000;		// --rare runs unless --max-runs says otherwise
+    bool numa = false;
+    PlayerTracker tracker;
+    BracketOptions bracket;
+    LightOptions lights;
+    RopeOptions rope;
+    unsigned int processCount = 0;
+    uint64_t shardedRuns = 1000;
+    size_t shardRuns = 64;
+    const char* exportPath = nullptr;
+    const char* cacheDir = nullptr;
+    ResultWriter::Format exportFormat = ResultWriter::Columnar;
+    bool syntheticPlayers = false;
+    size_t interleaveWidth = 0;
+    bool lanes = false;
+    const char* metricsPath = nullptr;
+    unsigned int metricsPort = 0;
+    double metricsInterval = 1.0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--compact") == 0)
+            compact = true;
+        else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc)
+            playerCount = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--fork") == 0 && i + 1 < argc)
+            forkAt = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--branches") == 0 && i + 1 < argc)
+            branchCount = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--estimate") == 0 && i + 1 < argc)
+        {
+            estimate = true;
+            estimateOptions.targetWidth = strtod(argv[++i], nullptr);
+        }
+        else if (strcmp(argv[i], "--track") == 0 && i + 1 < argc)
+            trackedPlayers.push_back(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--max-runs") == 0 && i + 1 < argc)
+        {
+            estimateOptions.maxRuns = strtoull(argv[++i], nullptr, 10);
+            rareRuns = estimateOptions.maxRuns;
+        }
+        else if (strcmp(argv[i], "--max-seconds") == 0 && i + 1 < argc)
+            estimateOptions.maxSeconds = strtod(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--rare") == 0 && i + 1 < argc)
+            rareTarget = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--bias") == 0 && i + 1 < argc)
+            rareBias = strtof(argv[++i], nullptr);
+        else if (strcmp(argv[i], "--follow") == 0 && i + 1 < argc)
+            tracker.track(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--seeding") == 0 && i + 1 < argc && parseSeeding(argv[i + 1], bracket.seeding))
+            ++i;
+        else if (strcmp(argv[i], "--bracket-rounds") == 0 && i + 1 < argc)
+            bracket.maxRounds = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--bracket-target") == 0 && i + 1 < argc)
+            bracket.target = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--lights") == 0)
+            lights.enabled = true;
+        else if (strcmp(argv[i], "--look-delay") == 0 && i + 1 < argc && parseLookDelay(argv[i + 1], lights))
+            ++i;
+        else if (strcmp(argv[i], "--rope-rounds") == 0 && i + 1 < argc)
+            rope.rounds = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--rope-split") == 0 && i + 1 < argc && parseRopeSplit(argv[i + 1], rope.split))
+            ++i;
+        else if (strcmp(argv[i], "--rope-candidates") == 0 && i + 1 < argc)
+            rope.candidates = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--numa") == 0)
+            numa = true;
+        else if (strcmp(argv[i], "--export") == 0 && i + 1 < argc)
+            exportPath = argv[++i];
+        else if (strcmp(argv[i], "--csv") == 0)
+            exportFormat = ResultWriter::Csv;
+        else if (strcmp(argv[i], "--processes") == 0 && i + 1 < argc)
+            processCount = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            shardedRuns = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--shard-size") == 0 && i + 1 < argc)
+            shardRuns = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if (strcmp(argv[i], "--interleave") == 0 && i + 1 < argc)
+            interleaveWidth = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--lanes") == 0)
+            lanes = true;
+        else if (strcmp(argv[i], "--short-floats") == 0)
+            TextOut::standard().setFloatStyle(TextOut::Short);
+        else if (strcmp(argv[i], "--synthetic") == 0)
+            syntheticPlayers = true;
+        else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+            metricsPath = argv[++i];
+        else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc)
+            metricsPort = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--metrics-interval") == 0 && i + 1 < argc)
+            metricsInterval = strtod(argv[++i], nullptr);
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << usage << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<Game*> games = makeGames(lights, rope, bracket);
+
+    // Classic play() draws from the shared Player buffer; --seed fixes it too
+    Player::getRandomBuffer().reseed(seed);
+
+    // --synthetic derives every player's attributes from (seed, number)
+    std::unique_ptr<SyntheticPopulation> synthetic;
+    if (syntheticPlayers)
+        synthetic.reset(new SyntheticPopulation(seed));
+
+    // --processes forks its workers, possibly again while it runs, so it
+    // goes first: a child must not inherit locks held by pool or exporter
+    // threads. The workers' counters stay in their own processes, so
+    // --metrics has nothing to export here.
+    if (processCount > 0 && interleaveWidth == 0 && !lanes)
+    {
+        if (metricsPath || metricsPort > 0)
+            std::cerr << "--metrics is not available with --processes" << std::endl;
+
+        runSharded(playerCount, seed, synthetic.get(), games, processCount, shardedRuns, shardRuns, cacheDir);
+
+        for (auto game : games)
+            delete game;
+        return 0;
+    }
+
+    // Drivers that split their work over the task pool; the others never
+    // start its threads
+    bool usesPool = interleaveWidth > 0 || lanes || rareTarget > 0 || estimate
+        || (branchCount > 0 && forkAt <= games.size()) || compact;
+
+    // --numa runs every driver on workers pinned one per CPU, node by node
+    std::unique_ptr<TaskScheduler> pinned;
+    TaskScheduler* scheduler = nullptr;
+    if (usesPool)
+    {
+        if (numa)
+            pinned.reset(new TaskScheduler(0, true));
+        scheduler = numa ? pinned.get() : &TaskScheduler::shared();
+    }
+    estimateOptions.scheduler = scheduler;
+
+    // --metrics / --metrics-port export live counters while the driver runs
+    std::unique_ptr<MetricsExporter> metrics;
+    if (metricsPath || metricsPort > 0)
+    {
+        std::vector<std::string> names;
+        for (auto game : games)
+            names.push_back(game->getName());
+
+        metrics.reset(new MetricsExporter(names, scheduler));
+        if (!metrics->start(metricsPath ? metricsPath : "", metricsPort, metricsInterval))
+            std::cerr << "Cannot serve metrics on 127.0.0.1:" << metricsPort << std::endl;
+    }
+
+#ifdef __cpp_impl_coroutine
+    if (interleaveWidth > 0)
+        runInterleaved(playerCount, seed, synthetic.get(), games, interleaveWidth, shardedRuns, estimateOptions.maxSeconds, *scheduler);
+    else
+#else
+    if (interleaveWidth > 0)
+        std::cerr << "--interleave needs a compiler with C++20 coroutines" << std::endl;
+    else
+#endif
+    if (lanes)
+        runLanes(playerCount, seed, synthetic.get(), games, shardedRuns, estimateOptions.maxSeconds, *scheduler);
+    else if (rareTarget > 0)
+        runRareEvent(playerCount, seed, synthetic.get(), games, rareTarget, rareBias, rareRuns, *scheduler);
+    else if (estimate)
+        runEstimate(playerCount, seed, synthetic.get(), games, estimateOptions, trackedPlayers, exportPath, exportFormat);
+    else if (branchCount > 0 && forkAt <= games.size())
+        runForked(playerCount, seed, synthetic.get(), games, forkAt, branchCount, *scheduler);
+    else
+    {
+        if (compact)
+            runCompact(playerCount, seed, synthetic.get(), games, *scheduler, tracker);
+        else
+            runClassic(playerCount, synthetic.get(), games);
+
+        printSummaryTable(games);
+
+        if (compact && !tracker.isEmpty())
+        {
+            std::vector<std::string> names;
+            for (auto game : games)
+                names.push_back(game->getName());
+            tracker.printReport(names);
+        }
+    }
+
+    if (metrics)
+        metrics->stop();
 
     for (auto game : games)
         delete game;
 
-    // 마지막 남은 players 정리
-    for (auto player : players)
-        delete player;
-}
\ No newline at end of file
+    return 0;
+}
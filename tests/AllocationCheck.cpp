@@ -0,0 +1,79 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "../Game.h"
+#include "../Numa.h"
+#include "../Tournament.h"
+
+// Replays the compact tournament after a warm-up and counts heap allocations
+// and node arena blocks, which populations of 1 MB or more come from.
+// Exits with status 1 if any steady-state run allocated. Classic play()
+// creates a Player object per player and game, so it is not checked.
+//
+//   allocation_check [--players N] [--runs R] [--seed S]
+int main(int argc, char** argv)
+{
+	unsigned int playerCount = 200000;
+	uint64_t runs = 200;
+	uint64_t seed = 1;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string option = argv[i];
+		if (option == "--players" && i + 1 < argc)
+			playerCount = strtoul(argv[++i], nullptr, 10);
+		else if (option == "--runs" && i + 1 < argc)
+			runs = strtoull(argv[++i], nullptr, 10);
+		else if (option == "--seed" && i + 1 < argc)
+			seed = strtoull(argv[++i], nullptr, 10);
+		else
+		{
+			std::cerr << "Usage: " << argv[0] << " [--players N] [--runs R] [--seed S]" << std::endl;
+			return 2;
+		}
+	}
+
+	std::vector<Game*> games;
+	games.push_back(new RedLightGreenLight(20));
+	games.push_back(new RPS());
+	games.push_back(new TugOfWar());
+	games.push_back(new GlassBridge());
+	games.push_back(new Marbles());
+	games.push_back(new Ddakji());
+	games.push_back(new Pysical_Asia_ship());
+	games.push_back(new SquidGame());
+
+	RandomBuffer rng(seed);
+	Population population(playerCount);
+	for (unsigned int i = 0; i < playerCount; ++i)
+	{
+		unsigned int agility = rng.nextBelow(101);
+		population[i] = CompactPlayer(i + 1, agility, rng.nextBelow(101));
+	}
+
+	// No scheduler: the task split allocates, the games themselves must not
+	TournamentRunner runner(std::vector<const Game*>(games.begin(), games.end()));
+
+	const uint64_t warmupRuns = 3;
+	for (uint64_t run = 0; run < warmupRuns; ++run)
+		runner.run(population, seed + run);
+
+	uint64_t allocations = AllocationCounter::getAllocations();
+	uint64_t bytes = AllocationCounter::getBytes();
+	uint64_t blocks = NodeArena::getBlockCount();
+	for (uint64_t run = 0; run < runs; ++run)
+		runner.run(population, seed + warmupRuns + run);
+	allocations = AllocationCounter::getAllocations() - allocations;
+	bytes = AllocationCounter::getBytes() - bytes;
+	blocks = NodeArena::getBlockCount() - blocks;
+
+	std::cout << "Allocations in " << runs << " runs after warm-up: " << allocations
+		<< " (" << bytes << " bytes), arena blocks: " << blocks << std::endl;
+
+	for (auto game : games)
+		delete game;
+
+	return allocations == 0 && blocks == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "AllocationCounter.h"
+
+static std::atomic<uint64_t> allocations{ 0 };
+static std::atomic<uint64_t> allocatedBytes{ 0 };
+
+uint64_t AllocationCounter::getAllocations()
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocationCounter::getBytes()
+{
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+static void* countedAllocate(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	return std::malloc(size ? size : 1);
+}
+
+static void* countedAllocateAligned(size_t size, size_t alignment)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+	size = (size + alignment - 1) / alignment * alignment;
+#ifdef _MSC_VER
+	return _aligned_malloc(size ? size : alignment, alignment);
+#else
+	return std::aligned_alloc(alignment, size ? size : alignment);
+#endif
+}
+
+static void releaseAligned(void* pointer)
+{
+#ifdef _MSC_VER
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
+
+void* operator new(size_t size)
+{
+	if (void* pointer = countedAllocate(size))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return countedAllocate(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if (void* pointer = countedAllocateAligned(size, size_t(alignment)))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { releaseAligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { releaseAligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { releaseAligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { releaseAligned(pointer); }
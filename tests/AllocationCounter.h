@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+// Counts every allocation made through the global operator new.
+// Linking AllocationCounter.cpp replaces the global new/delete, so only
+// the allocation check links it; squid keeps the default allocator.
+class AllocationCounter
+{
+public:
+	static uint64_t getAllocations();
+	static uint64_t getBytes();
+};